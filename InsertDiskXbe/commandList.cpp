@@ -0,0 +1,303 @@
+#include "commandList.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define COMMAND_OP_MASK 0xff
+#define COMMAND_SIZE_SHIFT 8
+
+namespace
+{
+	typedef struct commandBuffer
+	{
+		uint32_t* dwords;
+		uint32_t count;
+		uint32_t capacity;
+		uint32_t commands;
+	} commandBuffer;
+
+	// Payload dword count of each op, replay rejects anything else. Set
+	// vertices holds its two header dwords ahead of the vertex bytes.
+	const uint32_t mPayloadSizes[commandOpCount] = { 2, 3, 2, 1, 1 + COMMAND_TRANSFORM_FLOATS, 3, 2, 5, 0, 2 };
+
+	commandBackend* mBackend = NULL;
+	commandBuffer mFrame = { NULL, 0, 0, 0 };
+	commandBuffer mLastFrame = { NULL, 0, 0, 0 };
+	uint32_t mSubmitted = 0;
+	bool mCapturing = false;
+	commandList::commandListStats mStats = { 0 };
+
+	// Storage is kept between frames and only ever grows
+	uint32_t* beginCommand(commandOp op, uint32_t payloadSize)
+	{
+		uint32_t size = 1 + payloadSize;
+		if (mFrame.count + size > mFrame.capacity)
+		{
+			uint32_t capacity = mFrame.capacity == 0 ? COMMAND_LIST_INITIAL_SIZE / sizeof(uint32_t) : mFrame.capacity * 2;
+			while (mFrame.count + size > capacity)
+			{
+				capacity *= 2;
+			}
+			uint32_t* dwords = (uint32_t*)realloc(mFrame.dwords, capacity * sizeof(uint32_t));
+			if (dwords == NULL)
+			{
+				return NULL;
+			}
+			mFrame.dwords = dwords;
+			mFrame.capacity = capacity;
+		}
+
+		uint32_t* command = mFrame.dwords + mFrame.count;
+		command[0] = (uint32_t)op | (payloadSize << COMMAND_SIZE_SHIFT);
+		mFrame.count += size;
+		mFrame.commands++;
+		return command + 1;
+	}
+
+	uint32_t* beginCommand(commandOp op)
+	{
+		return beginCommand(op, mPayloadSizes[op]);
+	}
+
+	bool isValidPayload(uint32_t op, uint32_t payloadSize, const uint32_t* payload)
+	{
+		if (op != commandOpSetVertices)
+		{
+			return payloadSize == mPayloadSizes[op];
+		}
+		if (payloadSize < mPayloadSizes[op])
+		{
+			return false;
+		}
+		uint64_t bytes = (uint64_t)payload[0] * payload[1];
+		return bytes <= (uint64_t)(payloadSize - mPayloadSizes[op]) * sizeof(uint32_t);
+	}
+}
+
+void commandList::setBackend(commandBackend* backend)
+{
+	submit();
+	mBackend = backend;
+}
+
+void commandList::setRenderState(uint32_t state, uint32_t value)
+{
+	uint32_t* payload = beginCommand(commandOpSetRenderState);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = state;
+	payload[1] = value;
+}
+
+void commandList::setTextureStageState(uint32_t stage, uint32_t type, uint32_t value)
+{
+	uint32_t* payload = beginCommand(commandOpSetTextureStageState);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = stage;
+	payload[1] = type;
+	payload[2] = value;
+}
+
+void commandList::setTexture(uint32_t stage, uint32_t texture)
+{
+	uint32_t* payload = beginCommand(commandOpSetTexture);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = stage;
+	payload[1] = texture;
+}
+
+void commandList::setVertexShader(uint32_t handle)
+{
+	uint32_t* payload = beginCommand(commandOpSetVertexShader);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = handle;
+}
+
+void commandList::setTransform(uint32_t state, const float* matrix)
+{
+	uint32_t* payload = beginCommand(commandOpSetTransform);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = state;
+	memcpy(payload + 1, matrix, COMMAND_TRANSFORM_FLOATS * sizeof(float));
+}
+
+void commandList::setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride)
+{
+	uint32_t* payload = beginCommand(commandOpSetStreamSource);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = stream;
+	payload[1] = vertexBuffer;
+	payload[2] = stride;
+}
+
+void commandList::setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex)
+{
+	uint32_t* payload = beginCommand(commandOpSetIndices);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = indexBuffer;
+	payload[1] = baseVertexIndex;
+}
+
+void* commandList::setVertices(uint32_t vertexCount, uint32_t stride)
+{
+	uint32_t dataSize = ((vertexCount * stride) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+	uint32_t* payload = beginCommand(commandOpSetVertices, mPayloadSizes[commandOpSetVertices] + dataSize);
+	if (payload == NULL)
+	{
+		return NULL;
+	}
+	payload[0] = vertexCount;
+	payload[1] = stride;
+	if (dataSize > 0)
+	{
+		payload[1 + dataSize] = 0;
+	}
+	return payload + 2;
+}
+
+void commandList::setCapturing(bool capturing)
+{
+	mCapturing = capturing;
+}
+
+bool commandList::isCapturing()
+{
+	return mCapturing;
+}
+
+void commandList::drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount)
+{
+	uint32_t* payload = beginCommand(commandOpDrawIndexed);
+	if (payload == NULL)
+	{
+		return;
+	}
+	payload[0] = primitiveType;
+	payload[1] = minIndex;
+	payload[2] = vertexCount;
+	payload[3] = startIndex;
+	payload[4] = primitiveCount;
+}
+
+void commandList::submit()
+{
+	if (mBackend != NULL && mSubmitted < mFrame.count)
+	{
+		replay(mFrame.dwords + mSubmitted, mFrame.count - mSubmitted, mBackend);
+	}
+	mSubmitted = mFrame.count;
+}
+
+void commandList::endFrame()
+{
+	beginCommand(commandOpEndFrame);
+	submit();
+
+	uint32_t bytes = mFrame.count * sizeof(uint32_t);
+	mStats.frames++;
+	mStats.commands += mFrame.commands;
+	mStats.bytes += bytes;
+	mStats.lastFrameCommands = mFrame.commands;
+	mStats.lastFrameBytes = bytes;
+	if (bytes > mStats.maxFrameBytes)
+	{
+		mStats.maxFrameBytes = bytes;
+	}
+
+	// The finished frame is kept and its old storage records the next one
+	commandBuffer lastFrame = mLastFrame;
+	mLastFrame = mFrame;
+	mFrame = lastFrame;
+	mFrame.count = 0;
+	mFrame.commands = 0;
+	mSubmitted = 0;
+}
+
+void commandList::getLastFrame(const uint32_t*& commands, uint32_t& dwordCount)
+{
+	commands = mLastFrame.dwords;
+	dwordCount = mLastFrame.count;
+}
+
+void commandList::getStats(commandListStats& stats)
+{
+	stats = mStats;
+}
+
+bool commandList::replay(const uint32_t* commands, uint32_t dwordCount, commandBackend* backend)
+{
+	uint32_t offset = 0;
+	while (offset < dwordCount)
+	{
+		uint32_t op = commands[offset] & COMMAND_OP_MASK;
+		uint32_t payloadSize = commands[offset] >> COMMAND_SIZE_SHIFT;
+		if (op >= commandOpCount || offset + 1 + payloadSize > dwordCount || isValidPayload(op, payloadSize, commands + offset + 1) == false)
+		{
+			return false;
+		}
+
+		const uint32_t* payload = commands + offset + 1;
+		if (op == commandOpSetRenderState)
+		{
+			backend->setRenderState(payload[0], payload[1]);
+		}
+		else if (op == commandOpSetTextureStageState)
+		{
+			backend->setTextureStageState(payload[0], payload[1], payload[2]);
+		}
+		else if (op == commandOpSetTexture)
+		{
+			backend->setTexture(payload[0], payload[1]);
+		}
+		else if (op == commandOpSetVertexShader)
+		{
+			backend->setVertexShader(payload[0]);
+		}
+		else if (op == commandOpSetTransform)
+		{
+			backend->setTransform(payload[0], (const float*)(payload + 1));
+		}
+		else if (op == commandOpSetStreamSource)
+		{
+			backend->setStreamSource(payload[0], payload[1], payload[2]);
+		}
+		else if (op == commandOpSetIndices)
+		{
+			backend->setIndices(payload[0], payload[1]);
+		}
+		else if (op == commandOpDrawIndexed)
+		{
+			backend->drawIndexed(payload[0], payload[1], payload[2], payload[3], payload[4]);
+		}
+		else if (op == commandOpSetVertices)
+		{
+			backend->setVertices(payload[0], payload[1], (const uint8_t*)(payload + 2));
+		}
+		else
+		{
+			backend->endFrame();
+		}
+		offset += 1 + payloadSize;
+	}
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+// Kept free of xtl.h outside of _XBOX so recorded streams can be replayed
+// through the headless backend on Linux.
+#if defined(_XBOX)
+#include "xboxinternals.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#define COMMAND_LIST_INITIAL_SIZE (16 * 1024)
+#define COMMAND_TRANSFORM_FLOATS 16
+
+// Every command is one header dword, the op in the low byte and the
+// payload dword count above it, followed by its payload dwords. Only
+// commandOpSetVertices varies in size, its payload is the vertex count,
+// the stride and the vertex bytes padded to a whole dword.
+typedef enum commandOp
+{
+	commandOpSetRenderState = 0,
+	commandOpSetTextureStageState = 1,
+	commandOpSetTexture = 2,
+	commandOpSetVertexShader = 3,
+	commandOpSetTransform = 4,
+	commandOpSetStreamSource = 5,
+	commandOpSetIndices = 6,
+	commandOpDrawIndexed = 7,
+	commandOpEndFrame = 8,
+	commandOpSetVertices = 9,
+	commandOpCount = 10
+} commandOp;
+
+// Receives replayed commands. Textures and buffers arrive as the 32 bit
+// handles they were recorded with, only the backend that recorded them
+// may turn them back into pointers. setVertices carries a copy of the
+// vertices the next draw reads so a stream can be checked off the
+// console, a device backend already has them in its vertex buffer.
+class commandBackend
+{
+public:
+
+	virtual ~commandBackend() {}
+	virtual void setRenderState(uint32_t state, uint32_t value) = 0;
+	virtual void setTextureStageState(uint32_t stage, uint32_t type, uint32_t value) = 0;
+	virtual void setTexture(uint32_t stage, uint32_t texture) = 0;
+	virtual void setVertexShader(uint32_t handle) = 0;
+	virtual void setTransform(uint32_t state, const float* matrix) = 0;
+	virtual void setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride) = 0;
+	virtual void setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex) = 0;
+	virtual void setVertices(uint32_t vertexCount, uint32_t stride, const uint8_t* vertices) = 0;
+	virtual void drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount) = 0;
+	virtual void endFrame() = 0;
+};
+
+class commandList
+{
+public:
+
+	typedef struct commandListStats
+	{
+		uint32_t frames;
+		uint32_t commands;
+		uint32_t bytes;
+		uint32_t lastFrameCommands;
+		uint32_t lastFrameBytes;
+		uint32_t maxFrameBytes;
+	} commandListStats;
+
+	// Draws and state changes are recorded into the frame's stream and
+	// handed to the backend on submit, which plays everything recorded
+	// since the previous submit. endFrame records the end of the frame,
+	// submits it and keeps the finished stream for getLastFrame.
+	// Recording is only ever done from the main thread.
+	static void setBackend(commandBackend* backend);
+	static void setRenderState(uint32_t state, uint32_t value);
+	static void setTextureStageState(uint32_t stage, uint32_t type, uint32_t value);
+	static void setTexture(uint32_t stage, uint32_t texture);
+	static void setVertexShader(uint32_t handle);
+	static void setTransform(uint32_t state, const float* matrix);
+	static void setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride);
+	static void setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex);
+	// Returns room in the stream for the vertices the next draw reads,
+	// they are written there first and copied on into the vertex ring so
+	// the write combined ring is never read back. Only frames recorded
+	// while capturing carry their vertices, the rest write the ring.
+	static void* setVertices(uint32_t vertexCount, uint32_t stride);
+	static void setCapturing(bool capturing);
+	static bool isCapturing();
+	static void drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount);
+	static void submit();
+	static void endFrame();
+	static void getLastFrame(const uint32_t*& commands, uint32_t& dwordCount);
+	static void getStats(commandListStats& stats);
+
+	// Plays a recorded stream into any backend, false when the stream is
+	// truncated or holds an unknown op
+	static bool replay(const uint32_t* commands, uint32_t dwordCount, commandBackend* backend);
+};
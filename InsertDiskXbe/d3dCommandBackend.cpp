@@ -0,0 +1,52 @@
+#include "d3dCommandBackend.h"
+#include "context.h"
+
+void d3dCommandBackend::setRenderState(uint32_t state, uint32_t value)
+{
+	context::getD3dDevice()->SetRenderState((D3DRENDERSTATETYPE)state, value);
+}
+
+void d3dCommandBackend::setTextureStageState(uint32_t stage, uint32_t type, uint32_t value)
+{
+	context::getD3dDevice()->SetTextureStageState(stage, (D3DTEXTURESTAGESTATETYPE)type, value);
+}
+
+void d3dCommandBackend::setTexture(uint32_t stage, uint32_t texture)
+{
+	context::getD3dDevice()->SetTexture(stage, (D3DBaseTexture*)texture);
+}
+
+void d3dCommandBackend::setVertexShader(uint32_t handle)
+{
+	context::getD3dDevice()->SetVertexShader(handle);
+}
+
+void d3dCommandBackend::setTransform(uint32_t state, const float* matrix)
+{
+	context::getD3dDevice()->SetTransform((D3DTRANSFORMSTATETYPE)state, (const D3DMATRIX*)matrix);
+}
+
+void d3dCommandBackend::setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride)
+{
+	context::getD3dDevice()->SetStreamSource(stream, (D3DVertexBuffer*)vertexBuffer, stride);
+}
+
+void d3dCommandBackend::setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex)
+{
+	context::getD3dDevice()->SetIndices((D3DIndexBuffer*)indexBuffer, baseVertexIndex);
+}
+
+void d3dCommandBackend::setVertices(uint32_t vertexCount, uint32_t stride, const uint8_t* vertices)
+{
+	// The draw reads its vertices from the ring they were written to
+}
+
+void d3dCommandBackend::drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount)
+{
+	context::getD3dDevice()->DrawIndexedPrimitive((D3DPRIMITIVETYPE)primitiveType, minIndex, vertexCount, startIndex, primitiveCount);
+}
+
+void d3dCommandBackend::endFrame()
+{
+	// EndScene and Present stay with drawing::endFrame
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "commandList.h"
+
+// Plays commands straight into the device from context, handles are the
+// pointers deviceState recorded them from
+class d3dCommandBackend : public commandBackend
+{
+public:
+
+	virtual void setRenderState(uint32_t state, uint32_t value);
+	virtual void setTextureStageState(uint32_t stage, uint32_t type, uint32_t value);
+	virtual void setTexture(uint32_t stage, uint32_t texture);
+	virtual void setVertexShader(uint32_t handle);
+	virtual void setTransform(uint32_t state, const float* matrix);
+	virtual void setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride);
+	virtual void setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex);
+	virtual void setVertices(uint32_t vertexCount, uint32_t stride, const uint8_t* vertices);
+	virtual void drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount);
+	virtual void endFrame();
+};
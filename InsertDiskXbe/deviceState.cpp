@@ -0,0 +1,207 @@
+#include "deviceState.h"
+#include "commandList.h"
+#include "context.h"
+
+#include <string.h>
+
+#define DEVICE_STATE_TRANSFORMS 3
+
+namespace
+{
+	DWORD mRenderStates[D3DRS_MAX];
+	bool mRenderStateValid[D3DRS_MAX];
+	DWORD mStageStates[DEVICE_STATE_MAX_STAGES][D3DTSS_MAX];
+	bool mStageStateValid[DEVICE_STATE_MAX_STAGES][D3DTSS_MAX];
+	D3DBaseTexture* mTextures[DEVICE_STATE_MAX_STAGES];
+	bool mTextureValid[DEVICE_STATE_MAX_STAGES];
+	DWORD mVertexShader = 0;
+	bool mVertexShaderValid = false;
+	D3DMATRIX mTransforms[DEVICE_STATE_TRANSFORMS];
+	bool mTransformValid[DEVICE_STATE_TRANSFORMS];
+	D3DVertexBuffer* mVertexBuffer = NULL;
+	UINT mStride = 0;
+	bool mStreamValid = false;
+	D3DIndexBuffer* mIndexBuffer = NULL;
+	UINT mBaseVertexIndex = 0;
+	bool mIndicesValid = false;
+
+	deviceState::stateStats mStats = { 0 };
+	uint32_t mFrameSubmitted = 0;
+	uint32_t mFrameElided = 0;
+
+	// Only the fixed function transforms the UI sets are cached
+	int32_t getTransformSlot(D3DTRANSFORMSTATETYPE state)
+	{
+		if (state == D3DTS_VIEW)
+		{
+			return 0;
+		}
+		if (state == D3DTS_PROJECTION)
+		{
+			return 1;
+		}
+		if (state == D3DTS_WORLD)
+		{
+			return 2;
+		}
+		return -1;
+	}
+
+	bool elide(bool unchanged)
+	{
+		if (unchanged == true)
+		{
+			mFrameElided++;
+			return true;
+		}
+		mFrameSubmitted++;
+		return false;
+	}
+}
+
+void deviceState::invalidate()
+{
+	memset(mRenderStateValid, 0, sizeof(mRenderStateValid));
+	memset(mStageStateValid, 0, sizeof(mStageStateValid));
+	memset(mTextureValid, 0, sizeof(mTextureValid));
+	memset(mTransformValid, 0, sizeof(mTransformValid));
+	mVertexShaderValid = false;
+	mStreamValid = false;
+	mIndicesValid = false;
+}
+
+void deviceState::setRenderState(D3DRENDERSTATETYPE state, DWORD value)
+{
+	if (state >= D3DRS_MAX)
+	{
+		commandList::setRenderState(state, value);
+		return;
+	}
+	if (elide(mRenderStateValid[state] == true && mRenderStates[state] == value) == true)
+	{
+		return;
+	}
+	mRenderStates[state] = value;
+	mRenderStateValid[state] = true;
+	commandList::setRenderState(state, value);
+}
+
+void deviceState::setTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value)
+{
+	if (stage >= DEVICE_STATE_MAX_STAGES || type >= D3DTSS_MAX)
+	{
+		commandList::setTextureStageState(stage, type, value);
+		return;
+	}
+	if (elide(mStageStateValid[stage][type] == true && mStageStates[stage][type] == value) == true)
+	{
+		return;
+	}
+	mStageStates[stage][type] = value;
+	mStageStateValid[stage][type] = true;
+	commandList::setTextureStageState(stage, type, value);
+}
+
+void deviceState::setTexture(DWORD stage, D3DBaseTexture* texture)
+{
+	if (stage >= DEVICE_STATE_MAX_STAGES)
+	{
+		commandList::setTexture(stage, (uint32_t)texture);
+		return;
+	}
+	if (elide(mTextureValid[stage] == true && mTextures[stage] == texture) == true)
+	{
+		return;
+	}
+	mTextures[stage] = texture;
+	mTextureValid[stage] = true;
+	commandList::setTexture(stage, (uint32_t)texture);
+}
+
+void deviceState::forgetTexture(D3DBaseTexture* texture)
+{
+	for (DWORD stage = 0; stage < DEVICE_STATE_MAX_STAGES; stage++)
+	{
+		if (mTextureValid[stage] == false || mTextures[stage] == texture)
+		{
+			mTextures[stage] = NULL;
+			mTextureValid[stage] = true;
+			commandList::setTexture(stage, 0);
+		}
+	}
+	commandList::submit();
+	context::getD3dDevice()->BlockUntilIdle();
+}
+
+void deviceState::setVertexShader(DWORD handle)
+{
+	if (elide(mVertexShaderValid == true && mVertexShader == handle) == true)
+	{
+		return;
+	}
+	mVertexShader = handle;
+	mVertexShaderValid = true;
+	commandList::setVertexShader(handle);
+}
+
+void deviceState::setTransform(D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix)
+{
+	int32_t slot = getTransformSlot(state);
+	if (slot < 0)
+	{
+		commandList::setTransform(state, (const float*)matrix);
+		return;
+	}
+	if (elide(mTransformValid[slot] == true && memcmp(&mTransforms[slot], matrix, sizeof(D3DMATRIX)) == 0) == true)
+	{
+		return;
+	}
+	mTransforms[slot] = *matrix;
+	mTransformValid[slot] = true;
+	commandList::setTransform(state, (const float*)matrix);
+}
+
+void deviceState::setStreamSource(UINT stream, D3DVertexBuffer* vertexBuffer, UINT stride)
+{
+	if (stream != 0)
+	{
+		commandList::setStreamSource(stream, (uint32_t)vertexBuffer, stride);
+		return;
+	}
+	if (elide(mStreamValid == true && mVertexBuffer == vertexBuffer && mStride == stride) == true)
+	{
+		return;
+	}
+	mVertexBuffer = vertexBuffer;
+	mStride = stride;
+	mStreamValid = true;
+	commandList::setStreamSource(stream, (uint32_t)vertexBuffer, stride);
+}
+
+void deviceState::setIndices(D3DIndexBuffer* indexBuffer, UINT baseVertexIndex)
+{
+	if (elide(mIndicesValid == true && mIndexBuffer == indexBuffer && mBaseVertexIndex == baseVertexIndex) == true)
+	{
+		return;
+	}
+	mIndexBuffer = indexBuffer;
+	mBaseVertexIndex = baseVertexIndex;
+	mIndicesValid = true;
+	commandList::setIndices((uint32_t)indexBuffer, baseVertexIndex);
+}
+
+void deviceState::endFrame()
+{
+	mStats.frames++;
+	mStats.submitted += mFrameSubmitted;
+	mStats.elided += mFrameElided;
+	mStats.lastFrameSubmitted = mFrameSubmitted;
+	mStats.lastFrameElided = mFrameElided;
+	mFrameSubmitted = 0;
+	mFrameElided = 0;
+}
+
+void deviceState::getStats(stateStats& stats)
+{
+	stats = mStats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define DEVICE_STATE_MAX_STAGES 4
+
+class deviceState
+{
+public:
+
+	typedef struct stateStats
+	{
+		uint32_t frames;
+		uint32_t submitted;
+		uint32_t elided;
+		uint32_t lastFrameSubmitted;
+		uint32_t lastFrameElided;
+	} stateStats;
+
+	// Mirrors of the device setters that remember the last value sent and
+	// drop calls that would not change it, the rest are recorded into
+	// commandList. All device state must be set through here, invalidate
+	// forgets the cache for when something else touched the device.
+	static void invalidate();
+	static void setRenderState(D3DRENDERSTATETYPE state, DWORD value);
+	static void setTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value);
+	static void setTexture(DWORD stage, D3DBaseTexture* texture);
+	// Call before releasing a texture, unbinds it from any stage that may
+	// hold it and waits for the device to finish the draws that used it,
+	// so the cache can not match a new texture at the same address.
+	static void forgetTexture(D3DBaseTexture* texture);
+	static void setVertexShader(DWORD handle);
+	static void setTransform(D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix);
+	static void setStreamSource(UINT stream, D3DVertexBuffer* vertexBuffer, UINT stride);
+	static void setIndices(D3DIndexBuffer* indexBuffer, UINT baseVertexIndex);
+	static void endFrame();
+	static void getStats(stateStats& stats);
+};
@@ -0,0 +1,181 @@
+#include "discProbe.h"
+#include "launchResolver.h"
+#include "driveManager.h"
+#include "sessionRecorder.h"
+#include "utils.h"
+
+#include <string.h>
+
+namespace
+{
+	// Tried in order, all resolved from a single listing of the disc root
+	const char* mLaunchCandidates[] =
+	{
+		"default.xbe",
+		"*\\default.xbe"
+	};
+
+	xbeHeader::xbeResult readXbe(const char* path, bool identityOnly, xbeHeader::xbeInfo& info)
+	{
+		if (identityOnly == true)
+		{
+			return xbeHeader::readIdentity(path, info);
+		}
+		xbeHeader::xbeResult result = xbeHeader::read(path, info);
+		if (result == xbeHeader::xbeResultOk)
+		{
+			result = xbeHeader::validate(info, XGetGameRegion());
+		}
+		return result;
+	}
+
+	bool lookupLaunchCache(const xbeHeader::xbeInfo& identity, launchCache::launchCacheEntry& entry)
+	{
+		return launchCache::lookup(launchCache::computeFingerprint(identity), entry);
+	}
+
+	discMounter mMounter = driveManager::mountInsertedDrive;
+	discClassifier mClassifier = mediaClassifier::classify;
+	xbeReader mXbeReader = readXbe;
+	launchCacheReader mLaunchCacheReader = lookupLaunchCache;
+	launchTargetResolver mTargetResolver = launchResolver::resolve;
+
+	void probeDisc(discProbe::probeResult* probe)
+	{
+		uint64_t mountStart = utils::getPerformanceCounter();
+		bool mounted = mMounter("D");
+		probe->mountedAt = utils::getPerformanceCounter();
+		sessionRecorder::record(sessionEventMount, mounted == true ? 1 : 0, (uint32_t)utils::getElapsedMilliseconds(mountStart, probe->mountedAt), NULL);
+
+		probe->media = mediaTypeUnclassified;
+
+		// Verify mode hashes the disc instead of launching it
+		if (probe->verify == true)
+		{
+			probe->probedAt = utils::getPerformanceCounter();
+			return;
+		}
+
+		// A disc seen before is recognised from its certificate alone and skips
+		// resolving launch targets, the full header read and validation.
+		xbeHeader::xbeInfo identity;
+		xbeHeader::xbeResult identityResult = mXbeReader(DISC_XBE_PATH, true, identity);
+		sessionRecorder::record(sessionEventFileExists, identityResult, identity.titleId, DISC_XBE_PATH);
+		if (identityResult == xbeHeader::xbeResultOk)
+		{
+			launchCache::launchCacheEntry entry;
+			bool cached = mLaunchCacheReader(identity, entry);
+			sessionRecorder::record(sessionEventCacheLookup, cached == true ? 1 : 0, cached == true ? entry.titleId : 0, cached == true ? entry.launchPath : NULL);
+			if (cached == true)
+			{
+				probe->probedAt = utils::getPerformanceCounter();
+				launchCache::recordHit(utils::getElapsedMilliseconds(probe->mountedAt, probe->probedAt));
+				utils::debugPrint("Launching cached disc (title id %08x)\n", entry.titleId);
+				probe->launch = true;
+				probe->titleId = entry.titleId;
+				strncpy(probe->launchPath, entry.launchPath, LAUNCH_CACHE_MAX_PATH - 1);
+				return;
+			}
+		}
+
+		pointerVector* launchTargets = mTargetResolver(DISC_ROOT_PATH, mLaunchCandidates, sizeof(mLaunchCandidates) / sizeof(mLaunchCandidates[0]));
+		sessionRecorder::record(sessionEventResolve, launchTargets->count(), 0, NULL);
+		for (uint32_t i = 0; i < launchTargets->count(); i++)
+		{
+			launchResolver::launchTarget* launchTarget = (launchResolver::launchTarget*)launchTargets->get(i);
+			sessionRecorder::record(sessionEventLaunchTarget, launchTarget->confirmed == true ? 1 : 0, 0, launchTarget->launchPath);
+		}
+
+		// The first specific reason wins, NULL until one is found
+		probe->rejectReason = NULL;
+		for (uint32_t i = 0; i < launchTargets->count(); i++)
+		{
+			launchResolver::launchTarget* launchTarget = (launchResolver::launchTarget*)launchTargets->get(i);
+
+			xbeHeader::xbeInfo xbeInfo;
+			xbeHeader::xbeResult result = mXbeReader(launchTarget->xbePath, false, xbeInfo);
+			sessionRecorder::record(sessionEventFileExists, result, xbeInfo.titleId, launchTarget->xbePath);
+			if (result == xbeHeader::xbeResultReadFailed && launchTarget->confirmed == false)
+			{
+				continue;
+			}
+			if (result != xbeHeader::xbeResultOk)
+			{
+				utils::debugPrint("Rejected %s: %s\n", launchTarget->xbePath, xbeHeader::getResultString(result));
+				if (probe->rejectReason == NULL)
+				{
+					probe->rejectReason = xbeHeader::getResultString(result);
+				}
+				// A root default.xbe that is present but rejected is the disc's
+				// answer, folders are only searched when the root has none
+				if (launchTarget->confirmed == true)
+				{
+					break;
+				}
+				continue;
+			}
+			probe->probedAt = utils::getPerformanceCounter();
+
+			launchCache::store(launchCache::computeFingerprint(xbeInfo), xbeInfo.titleId, launchTarget->launchPath);
+			launchCache::recordMiss(utils::getElapsedMilliseconds(probe->mountedAt, probe->probedAt));
+
+			utils::debugPrint("Launching %s from %s (title id %08x)\n", xbeInfo.titleName, launchTarget->launchPath, xbeInfo.titleId);
+			probe->launch = true;
+			probe->titleId = xbeInfo.titleId;
+			strncpy(probe->launchPath, launchTarget->launchPath, LAUNCH_CACHE_MAX_PATH - 1);
+			break;
+		}
+		delete(launchTargets);
+
+		// Only a disc without a launchable XBE is classified, and then only to
+		// tell the user why. Pressed discs show their DVD-Video partition until
+		// authenticated, so the classifier must never keep a disc from the probe.
+		if (probe->launch == false)
+		{
+			probe->media = mClassifier();
+			sessionRecorder::record(sessionEventMedia, probe->media, 0, NULL);
+			const char* mediaMessage = mediaClassifier::getMediaTypeMessage(probe->media);
+			if (probe->rejectReason == NULL && strlen(mediaMessage) > 0)
+			{
+				probe->rejectReason = mediaMessage;
+			}
+			if (probe->rejectReason == NULL)
+			{
+				probe->rejectReason = NO_LAUNCH_TARGET_MESSAGE;
+			}
+			probe->probedAt = utils::getPerformanceCounter();
+		}
+	}
+}
+
+void discProbe::setMounter(discMounter mounter)
+{
+	mMounter = mounter;
+}
+
+void discProbe::setClassifier(discClassifier classifier)
+{
+	mClassifier = classifier;
+}
+
+void discProbe::setXbeReader(xbeReader reader)
+{
+	mXbeReader = reader;
+}
+
+void discProbe::setLaunchCacheReader(launchCacheReader reader)
+{
+	mLaunchCacheReader = reader;
+}
+
+void discProbe::setTargetResolver(launchTargetResolver resolver)
+{
+	mTargetResolver = resolver;
+}
+
+void discProbe::run(probeResult* probe)
+{
+	probeDisc(probe);
+	sessionProbeResult result = probe->verify == true ? sessionProbeVerify : (probe->launch == true ? sessionProbeLaunch : sessionProbeRejected);
+	sessionRecorder::record(sessionEventProbe, result, probe->titleId, probe->launch == true ? probe->launchPath : probe->rejectReason);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "xboxinternals.h"
+#include "xbeHeader.h"
+#include "launchCache.h"
+#include "mediaClassifier.h"
+#include "pointerVector.h"
+
+#define DISC_ROOT_PATH "D:"
+#define DISC_XBE_PATH "D:\\default.xbe"
+#define NO_LAUNCH_TARGET_MESSAGE "No launchable XBE found"
+
+// Every answer the probe takes from the disc goes through one of these, the
+// defaults reach the drive, sessionRecorder swaps in replayed answers.
+typedef bool (*discMounter)(const char* driveLetter);
+typedef mediaType (*discClassifier)();
+typedef xbeHeader::xbeResult (*xbeReader)(const char* path, bool identityOnly, xbeHeader::xbeInfo& info);
+typedef bool (*launchCacheReader)(const xbeHeader::xbeInfo& identity, launchCache::launchCacheEntry& entry);
+typedef pointerVector* (*launchTargetResolver)(const char* rootPath, const char** candidates, uint32_t candidateCount);
+
+class discProbe
+{
+public:
+
+	typedef struct probeResult
+	{
+		uint32_t epoch;
+		mediaType media;
+		bool verify;
+		bool launch;
+		uint32_t titleId;
+		char launchPath[LAUNCH_CACHE_MAX_PATH];
+		const char* rejectReason;
+		uint64_t mountedAt;
+		uint64_t probedAt;
+	} probeResult;
+
+	static void setMounter(discMounter mounter);
+	static void setClassifier(discClassifier classifier);
+	static void setXbeReader(xbeReader reader);
+	static void setLaunchCacheReader(launchCacheReader reader);
+	static void setTargetResolver(launchTargetResolver resolver);
+
+	// Mounts D: and settles what to do with the disc, recording every answer
+	// to sessionRecorder. The caller sets epoch and verify, verify stops
+	// after the mount. An xbeReader validates full reads against the region.
+	static void run(probeResult* probe);
+};
@@ -0,0 +1,126 @@
+#include "discWorker.h"
+#include "utils.h"
+
+#define DISC_JOB_RUNNING 0
+#define DISC_JOB_COMPLETED 1
+#define DISC_JOB_ABANDONED 2
+
+namespace
+{
+	typedef struct discJob
+	{
+		discJobCallback callback;
+		void* userData;
+		uint32_t startTime;
+		uint32_t deadline;
+		volatile LONG state;
+	} discJob;
+
+	discJob* mJob = NULL;
+	discWorker::discWorkerStats mStats = { 0 };
+
+	// Threads of abandoned jobs that have not returned yet, counted up by
+	// poll before it abandons a job and down by the thread as it exits
+	volatile LONG mAbandonedCount = 0;
+
+	DWORD WINAPI workerThread(LPVOID param)
+	{
+		discJob* job = (discJob*)param;
+		job->callback(job->userData);
+
+		// Nothing refers to an abandoned job any more, so it is freed here
+		if (InterlockedCompareExchange(&job->state, DISC_JOB_COMPLETED, DISC_JOB_RUNNING) == DISC_JOB_ABANDONED)
+		{
+			utils::debugPrint("Stalled disc job returned after %ums\n", GetTickCount() - job->startTime);
+			free(job->userData);
+			free(job);
+			InterlockedDecrement(&mAbandonedCount);
+		}
+		return 0;
+	}
+}
+
+bool discWorker::start(discJobCallback callback, void* userData, uint32_t deadline)
+{
+	if (mJob != NULL || mAbandonedCount != 0)
+	{
+		return false;
+	}
+
+	discJob* job = (discJob*)malloc(sizeof(discJob));
+	job->callback = callback;
+	job->userData = userData;
+	job->startTime = GetTickCount();
+	job->deadline = deadline;
+	job->state = DISC_JOB_RUNNING;
+
+	HANDLE thread = CreateThread(NULL, 0, workerThread, job, 0, NULL);
+	if (thread == NULL)
+	{
+		free(job);
+		return false;
+	}
+	CloseHandle(thread);
+
+	mJob = job;
+	mStats.jobs++;
+	return true;
+}
+
+discJobState discWorker::poll(void** userData)
+{
+	*userData = NULL;
+
+	if (mJob == NULL)
+	{
+		return discJobStateIdle;
+	}
+
+	if (mJob->state == DISC_JOB_COMPLETED)
+	{
+		*userData = mJob->userData;
+		free(mJob);
+		mJob = NULL;
+		return discJobStateCompleted;
+	}
+
+	uint32_t elapsed = GetTickCount() - mJob->startTime;
+	if (elapsed < mJob->deadline)
+	{
+		return discJobStateRunning;
+	}
+
+	// Counted first so a thread returning right after the exchange can not
+	// take the count below zero
+	InterlockedIncrement(&mAbandonedCount);
+	if (InterlockedCompareExchange(&mJob->state, DISC_JOB_ABANDONED, DISC_JOB_RUNNING) == DISC_JOB_COMPLETED)
+	{
+		InterlockedDecrement(&mAbandonedCount);
+		*userData = mJob->userData;
+		free(mJob);
+		mJob = NULL;
+		return discJobStateCompleted;
+	}
+
+	utils::debugPrint("Disc job stalled, abandoned after %ums\n", elapsed);
+	mStats.stalls++;
+	mStats.lastStallMilliseconds = elapsed;
+	mStats.maxStallMilliseconds = max(mStats.maxStallMilliseconds, elapsed);
+	mJob = NULL;
+	return discJobStateStalled;
+}
+
+bool discWorker::isBusy()
+{
+	return mJob != NULL;
+}
+
+bool discWorker::hasAbandonedJob()
+{
+	return mAbandonedCount != 0;
+}
+
+void discWorker::getStats(discWorkerStats& stats)
+{
+	stats = mStats;
+}
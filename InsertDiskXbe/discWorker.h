@@ -0,0 +1,40 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define DISC_JOB_DEADLINE 8000
+
+typedef void (*discJobCallback)(void* userData);
+
+typedef enum discJobState
+{
+	discJobStateIdle = 0,
+	discJobStateRunning = 1,
+	discJobStateCompleted = 2,
+	discJobStateStalled = 3
+} discJobState;
+
+class discWorker
+{
+public:
+
+	typedef struct discWorkerStats
+	{
+		uint32_t jobs;
+		uint32_t stalls;
+		uint32_t lastStallMilliseconds;
+		uint32_t maxStallMilliseconds;
+	} discWorkerStats;
+
+	// userData must come from malloc, ownership passes to the worker until
+	// poll hands it back. A stalled job is abandoned, the worker is free
+	// again at once so the caller can dismount the drive the thread is
+	// blocked in, its thread frees the job and userData when it returns.
+	// start is refused until then so only one thread is ever inside the
+	// drive.
+	static bool start(discJobCallback callback, void* userData, uint32_t deadline);
+	static discJobState poll(void** userData);
+	static bool isBusy();
+	static bool hasAbandonedJob();
+	static void getStats(discWorkerStats& stats);
+};
@@ -5,6 +5,12 @@
 #include "meshUtility.h"
 #include "stringUtility.h"
 #include "pointerMap.h"
+#include "fiberScheduler.h"
+#include "startupTimeline.h"
+#include "sectionLoader.h"
+#include "spriteBatch.h"
+#include "deviceState.h"
+#include "commandList.h"
 
 #include <xgraphics.h>
 
@@ -16,16 +22,15 @@
 #define SSFN_free free
 #include "ssfn.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_ASSERT(x)
 #include "stb_image.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
-
 namespace
 {
 	ssfn_t* mFontContext = NULL;
+
+	bool mFrameDirty = true;
+	uint32_t mFramesRendered = 0;
+	uint32_t mFramesSkipped = 0;
 }
 
 inline unsigned char lerp(unsigned  char a, unsigned char b, float t)
@@ -138,6 +143,7 @@ void drawing::removeImage(const char* key)
 	image* imageToRemove = (image*)context::getImageMap()->get(key);
 	if (imageToRemove != NULL)
 	{
+		deviceState::forgetTexture(imageToRemove->texture);
 		imageToRemove->texture->Release();
 		context::getImageMap()->removeKey(key);
 	}
@@ -147,7 +153,12 @@ bool drawing::loadImage(const char* buffer, uint32_t length, const char* key)
 {
 	int width;
 	int height;
+	if (sectionLoader::load(sectionGroupImageCodec) == false)
+	{
+		return false;
+	}
 	uint8_t* imageData = (uint8_t*)stbi_load_from_memory((const stbi_uc*)buffer, length, &width, &height, NULL, STBI_rgb_alpha);
+	sectionLoader::unload(sectionGroupImageCodec);
 	if (imageData == NULL)
 	{
 		return false;
@@ -165,7 +176,9 @@ bool drawing::loadFont(const uint8_t* data)
 		memset(mFontContext, 0, sizeof(ssfn_t));
 	}
 
+	int32_t spanId = startupTimeline::begin("ssfn_load", 0);
 	int result = ssfn_load(mFontContext, data);
+	startupTimeline::end(spanId);
 	return result == 0;
 }
 
@@ -174,6 +187,41 @@ void drawing::clearBackground()
 	context::getD3dDevice()->Clear(0L, NULL, D3DCLEAR_TARGET|D3DCLEAR_ZBUFFER|D3DCLEAR_STENCIL, 0xff000000, 1.0f, 0L);
 }
 
+void drawing::invalidateFrame()
+{
+	mFrameDirty = true;
+}
+
+bool drawing::beginFrame()
+{
+	if (mFrameDirty == false)
+	{
+		// Back buffer is preserved by D3DSWAPEFFECT_COPY so the last
+		// presented frame stays on screen.
+		mFramesSkipped++;
+		return false;
+	}
+	context::getD3dDevice()->BeginScene();
+	return true;
+}
+
+void drawing::endFrame()
+{
+	spriteBatch::endFrame();
+	deviceState::endFrame();
+	commandList::endFrame();
+	context::getD3dDevice()->EndScene();
+	context::getD3dDevice()->Present(NULL, NULL, NULL, NULL);
+	mFrameDirty = false;
+	mFramesRendered++;
+}
+
+void drawing::getFrameStats(uint32_t& framesRendered, uint32_t& framesSkipped)
+{
+	framesRendered = mFramesRendered;
+	framesSkipped = mFramesSkipped;
+}
+
 bool drawing::imageExists(const char* key)
 {
 	image* result = (image*)context::getImageMap()->get(key);
@@ -188,7 +236,7 @@ image* drawing::getImage(const char* key)
 
 void drawing::setTint(unsigned int color)
 {
-	context::getD3dDevice()->SetRenderState(D3DRS_TEXTUREFACTOR, color);
+	deviceState::setRenderState(D3DRS_TEXTUREFACTOR, color);
 }
 
 void drawing::drawImage(image* image, uint32_t tint, int x, int y, int width, int height)
@@ -198,12 +246,8 @@ void drawing::drawImage(image* image, uint32_t tint, int x, int y, int width, in
 		return;
 
 	}
-	context::getD3dDevice()->SetRenderState(D3DRS_TEXTUREFACTOR, tint);
 	float newY = (float)context::getBufferHeight() - (y + height);
-	context::getD3dDevice()->SetTexture(0, image->texture);
-	utils::dataContainer* vertices = meshUtility::createQuadXY(math::vec3F((float)x + 0.5f, newY + 0.5f, 0), math::sizeF((float)width, (float)height), image->uvRect);
-	context::getD3dDevice()->DrawPrimitiveUP(D3DPT_TRIANGLELIST, (vertices->size / sizeof(meshUtility::vertex)) / 3, vertices->data, sizeof(meshUtility::vertex));
-	delete(vertices);
+	spriteBatch::addQuad(image->texture, math::vec3F((float)x + 0.5f, newY + 0.5f, 0), math::sizeF((float)width, (float)height), image->uvRect, tint);
 }
 
 void drawing::drawImage(image* image, uint32_t tint, int x, int y)
@@ -237,6 +281,11 @@ void drawing::drawImage(const char* imageKey, uint32_t tint, int x, int y)
 }
 
 bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int fontSize, int lineHeight, int spacing, int textureDimension)
+{
+	return generateBitmapFont(fontName, fontStyle, fontSize, lineHeight, spacing, textureDimension, " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~\xC2\xA1\xC2\xA2\xC2\xA3\xC2\xA4\xC2\xA5\xC2\xA6\xC2\xA7\xC2\xA8\xC2\xA9\xC2\xAA\xC2\xAB\xC2\xAC\xC2\xAD\xC2\xAE\xC2\xAF\xC2\xB0\xC2\xB1\xC2\xB2\xC2\xB3");
+}
+
+bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int fontSize, int lineHeight, int spacing, int textureDimension, const char* charsToEncode)
 {
 	bitmapFont* font = new bitmapFont();
 	font->charMap = new pointerMap(true);
@@ -252,8 +301,7 @@ bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int
 	int x = 2;
 	int y = 2;
 
-	char* charsToEncode = " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~\xC2\xA1\xC2\xA2\xC2\xA3\xC2\xA4\xC2\xA5\xC2\xA6\xC2\xA7\xC2\xA8\xC2\xA9\xC2\xAA\xC2\xAB\xC2\xAC\xC2\xAD\xC2\xAE\xC2\xAF\xC2\xB0\xC2\xB1\xC2\xB2\xC2\xB3";
-	char* currentCharPos = charsToEncode;
+	char* currentCharPos = (char*)charsToEncode;
 	while(*currentCharPos)
 	{	
 		char* nextCharPos = currentCharPos;
@@ -266,10 +314,24 @@ bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int
 
 		currentCharPos = nextCharPos;
 
+		// Glyph sets built from message text repeat characters
+		char* unicodeString = stringUtility::formatString("%i", unicode);
+		if (font->charMap->get(unicodeString) != NULL)
+		{
+			free(unicodeString);
+			free(currentChar);
+			continue;
+		}
+
+		int32_t spanId = startupTimeline::begin("Glyph", unicode);
+
 		Bounds bounds;
 		int ret = ssfn_bbox(mFontContext, currentChar, &bounds.width, &bounds.height, &bounds.left, &bounds.top);
 		if (ret != 0)
 		{
+			startupTimeline::end(spanId);
+			free(unicodeString);
+			free(currentChar);
 			continue;
 		}
 
@@ -285,7 +347,6 @@ bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int
 		rect->width = bounds.width;
 		rect->height = bounds.height;
 
-		char* unicodeString = stringUtility::formatString("%i", unicode);
 		font->charMap->add(unicodeString, rect);
 		free(unicodeString);
 
@@ -304,9 +365,15 @@ bitmapFont* drawing::generateBitmapFont(const char* fontName, int fontStyle, int
 
 		x = x + bounds.width + 2;   
 		free(currentChar);
+		startupTimeline::end(spanId);
+
+		// Lets the frame render between glyphs when run from a fiber
+		fiberScheduler::yieldIfOverBudget();
 	}
 
+	int32_t uploadSpanId = startupTimeline::begin("Atlas upload", textureWidth);
 	font->image = createImage((uint8_t*)imageData, D3DFMT_A8R8G8B8, textureWidth, textureHeight);
+	startupTimeline::end(uploadSpanId);
 	font->lineHeight = lineHeight;
 	font->spacing = spacing;
 	free(imageData);
@@ -336,7 +403,9 @@ void drawing::measureBitmapString(bitmapFont* font, const char* message, int* wi
 
 		currentCharPos = nextCharPos;
 
-		if (stringUtility::equals(currentChar, "\n", false) == true)
+		bool newLine = stringUtility::equals(currentChar, "\n", false);
+		free(currentChar);
+		if (newLine == true)
 		{
 			xPos = 0;
 			yPos += font->lineHeight;
@@ -353,7 +422,6 @@ void drawing::measureBitmapString(bitmapFont* font, const char* message, int* wi
 
 		xPos = xPos + rect->width + font->spacing;
 		xPosMax = max(xPosMax, xPos);
-		free(currentChar);
 	}
 
 	if (width != NULL)
@@ -387,7 +455,9 @@ void drawing::drawBitmapString(bitmapFont* font, const char* message, uint32_t c
 
 		currentCharPos = nextCharPos;
 
-		if (stringUtility::equals(currentChar, "\n", false) == true)
+		bool newLine = stringUtility::equals(currentChar, "\n", false);
+		free(currentChar);
+		if (newLine == true)
 		{
 			xPos = x;
 			yPos += font->lineHeight;
@@ -408,15 +478,10 @@ void drawing::drawBitmapString(bitmapFont* font, const char* message, uint32_t c
 		uvRect.width = rect->width / (float)image->width;
 		uvRect.height = rect->height / (float)image->height;
 
-		context::getD3dDevice()->SetRenderState(D3DRS_TEXTUREFACTOR, color);
 		float newY = (float)context::getBufferHeight() - (yPos + rect->height);
-		context::getD3dDevice()->SetTexture(0, image->texture);
-		utils::dataContainer* vertices = meshUtility::createQuadXY(math::vec3F((float)xPos + 0.5f, newY + 0.5f, 0), math::sizeF((float)rect->width, (float)rect->height), uvRect);
-		context::getD3dDevice()->DrawPrimitiveUP(D3DPT_TRIANGLELIST, (vertices->size / sizeof(meshUtility::vertex)) / 3, vertices->data, sizeof(meshUtility::vertex));
-		delete(vertices);
+		spriteBatch::addQuad(image->texture, math::vec3F((float)xPos + 0.5f, newY + 0.5f, 0), math::sizeF((float)rect->width, (float)rect->height), uvRect, color);
 
 		xPos = xPos + rect->width + font->spacing;
-		free(currentChar);
 	}
 }
 
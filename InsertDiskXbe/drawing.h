@@ -26,6 +26,10 @@ public:
 	static bool loadImage(const char* buffer, uint32_t length, const char* key);
 	static bool loadFont(const uint8_t* data);
 	static void clearBackground();
+	static void invalidateFrame();
+	static bool beginFrame();
+	static void endFrame();
+	static void getFrameStats(uint32_t& framesRendered, uint32_t& framesSkipped);
 	static bool imageExists(const char* key);
 	static image* getImage(const char* key);
 	static void setTint(unsigned int color);
@@ -34,6 +38,7 @@ public:
 	static void drawImage(const char* imageKey, uint32_t tint, int x, int y, int width, int height);
 	static void drawImage(const char* imageKey, uint32_t tint, int x, int y);
 	static bitmapFont* generateBitmapFont(const char* fontName, int fontStyle, int fontSize, int lineHeight, int spacing, int textureDimension);
+	static bitmapFont* generateBitmapFont(const char* fontName, int fontStyle, int fontSize, int lineHeight, int spacing, int textureDimension, const char* charsToEncode);
 	static void measureBitmapString(bitmapFont* font, const char* message, int* width, int* height);
 	static void drawBitmapString(bitmapFont* font, const char* message, uint32_t color, int x, int y);
 	static void drawBitmapStringAligned(bitmapFont* font, const char*  message, uint32_t color, horizAlignment hAlign, int x, int y, int width);
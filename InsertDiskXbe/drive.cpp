@@ -10,6 +10,7 @@ drive::drive(const char* mountPoint, const char* systemPath, bool shouldRemount)
 	mSystemPath = strdup(systemPath);
 	mMounted = false;
 	mShouldRemount = shouldRemount;
+	mMountEpoch = 0;
 }
 
 bool drive::mount()
@@ -48,6 +49,16 @@ bool drive::mount()
 	return mMounted;
 }
 
+bool drive::mount(uint32_t epoch)
+{
+	if (mMountEpoch == epoch)
+	{
+		return mMounted;
+	}
+	mMountEpoch = epoch;
+	return mount();
+}
+
 bool drive::unmount()
 {
 	char* mountPoint = stringUtility::formatString("\\??\\%s:", mMountPoint);
@@ -74,6 +85,16 @@ bool drive::isMounted()
 	return mMounted;
 }
 
+bool drive::shouldRemount()
+{
+	return mShouldRemount;
+}
+
+uint32_t drive::getMountEpoch()
+{
+	return mMountEpoch;
+}
+
 char* drive::getMountPoint()
 {
 	return strdup(mMountPoint);
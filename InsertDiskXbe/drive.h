@@ -10,8 +10,11 @@ class drive
 public:
 	drive(const char* mountPoint, const char* systemPath, bool shouldRemount);
 	bool mount();  		
+	bool mount(uint32_t epoch);
 	bool unmount();
 	bool isMounted();
+	bool shouldRemount();
+	uint32_t getMountEpoch();
 	char* getMountPoint();
 	char* getSystemPath();
 	uint64_t getTotalNumberOfBytes();
@@ -21,4 +24,5 @@ protected:
 	char* mSystemPath;
 	bool mMounted;
 	bool mShouldRemount;
+	uint32_t mMountEpoch;
 };
\ No newline at end of file
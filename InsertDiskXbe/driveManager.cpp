@@ -9,6 +9,31 @@ namespace
 	bool mInitialized;
 	bool mAllMounted;
 	pointerVector* m_drives = NULL;
+
+	// Written by trayStateChanged on the main thread, read by the disc
+	// worker while it mounts. The counters are bumped from both threads.
+	volatile LONG mInsertionActive = FALSE;
+	volatile LONG mInsertionEpoch = 0;
+	volatile LONG mMounts = 0;
+	volatile LONG mMountsSaved = 0;
+	volatile LONG mDismountsSaved = 0;
+	volatile LONG mProbesSaved = 0;
+
+	drive* findDrive(const char* driveLetter)
+	{
+		for (size_t i = 0; i < m_drives->count(); i++)
+		{
+			drive* currentDrive = (drive*)m_drives->get(i);
+			char* mountPoint = currentDrive->getMountPoint();
+			bool found = stringUtility::equals(mountPoint, driveLetter, true);
+			free(mountPoint);
+			if (found == true)
+			{
+				return currentDrive;
+			}
+		}
+		return NULL;
+	}
 }
 
 bool driveManager::getTotalNumberOfBytes(const char* mountPoint, uint64_t& totalSize)
@@ -162,6 +187,18 @@ bool driveManager::mountDrive(const char* driveLetter)
 	return false;
 }
 
+bool driveManager::unmountDrive(const char* driveLetter)
+{
+	init();
+
+	drive* currentDrive = findDrive(driveLetter);
+	if (currentDrive == NULL)
+	{
+		return false;
+	}
+	return currentDrive->unmount();
+}
+
 void driveManager::mountAllDrives()
 {
 	init();
@@ -177,4 +214,83 @@ void driveManager::mountAllDrives()
 bool driveManager::isAllMounted()
 {
 	return mAllMounted;
+}
+
+void driveManager::trayStateChanged(uint32_t trayState)
+{
+	if (trayState == SMC_TRAY_STATE_MEDIA_DETECT)
+	{
+		if (mInsertionActive == FALSE)
+		{
+			InterlockedIncrement(&mInsertionEpoch);
+			InterlockedExchange(&mInsertionActive, TRUE);
+		}
+	}
+	else if (trayState == SMC_TRAY_STATE_OPEN || trayState == SMC_TRAY_STATE_OPENING || trayState == SMC_TRAY_STATE_UNLOADING || trayState == SMC_TRAY_STATE_NO_MEDIA || trayState == SMC_TRAY_STATE_RESET)
+	{
+		InterlockedExchange(&mInsertionActive, FALSE);
+	}
+}
+
+uint32_t driveManager::getInsertionEpoch()
+{
+	return (uint32_t)mInsertionEpoch;
+}
+
+bool driveManager::mountInsertedDrive(const char* driveLetter)
+{
+	init();
+
+	drive* currentDrive = findDrive(driveLetter);
+	if (currentDrive == NULL)
+	{
+		return false;
+	}
+
+	if (mInsertionActive == FALSE)
+	{
+		InterlockedIncrement(&mMounts);
+		return currentDrive->mount();
+	}
+
+	uint32_t epoch = (uint32_t)mInsertionEpoch;
+	if (currentDrive->getMountEpoch() == epoch)
+	{
+		InterlockedIncrement(&mMountsSaved);
+		if (currentDrive->shouldRemount() == true && currentDrive->isMounted() == true)
+		{
+			InterlockedIncrement(&mDismountsSaved);
+		}
+		return currentDrive->isMounted();
+	}
+
+	InterlockedIncrement(&mMounts);
+	return currentDrive->mount(epoch);
+}
+
+void driveManager::probeSkipped(const char* driveLetter)
+{
+	init();
+
+	drive* currentDrive = findDrive(driveLetter);
+	if (currentDrive == NULL)
+	{
+		return;
+	}
+
+	InterlockedIncrement(&mProbesSaved);
+	InterlockedIncrement(&mMountsSaved);
+	if (currentDrive->shouldRemount() == true && currentDrive->isMounted() == true)
+	{
+		InterlockedIncrement(&mDismountsSaved);
+	}
+}
+
+void driveManager::getInsertionStats(insertionStats& stats)
+{
+	stats.epoch = (uint32_t)mInsertionEpoch;
+	stats.mounts = (uint32_t)mMounts;
+	stats.mountsSaved = (uint32_t)mMountsSaved;
+	stats.dismountsSaved = (uint32_t)mDismountsSaved;
+	stats.probesSaved = (uint32_t)mProbesSaved;
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Drive.h"
+#include "drive.h"
 #include "pointerVector.h"
 #include "xboxinternals.h"
 
@@ -9,6 +9,16 @@
 class driveManager
 {
 public:
+
+	typedef struct insertionStats
+	{
+		uint32_t epoch;
+		uint32_t mounts;
+		uint32_t mountsSaved;
+		uint32_t dismountsSaved;
+		uint32_t probesSaved;
+	} insertionStats;
+
 	static bool getTotalNumberOfBytes(const char* mountPoint, uint64_t& totalSize);
 	static bool getTotalFreeNumberOfBytes(const char* mountPoint, uint64_t& totalFree);
 	static pointerVector* getMountedDrives();
@@ -16,6 +26,14 @@ public:
 	static char* mapFtpPath(const char* path);
 	static void init();
 	static bool mountDrive(const char* driveLetter);
+	static bool unmountDrive(const char* driveLetter);
 	static void mountAllDrives();
 	static bool isAllMounted();
+	static void trayStateChanged(uint32_t trayState);
+	static uint32_t getInsertionEpoch();
+	static bool mountInsertedDrive(const char* driveLetter);
+	// Called for each poll that found the current insertion already
+	// probed, where a remount and probe used to run every frame
+	static void probeSkipped(const char* driveLetter);
+	static void getInsertionStats(insertionStats& stats);
 };
\ No newline at end of file
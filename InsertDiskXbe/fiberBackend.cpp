@@ -0,0 +1,174 @@
+#include "fiberBackend.h"
+
+#if !defined(_XBOX)
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#endif
+
+namespace
+{
+	typedef struct fiber
+	{
+#if defined(_XBOX)
+		LPVOID handle;
+#else
+		ucontext_t context;
+		void* stack;
+#endif
+		fiberEntry entry;
+		void* param;
+		bool finished;
+	} fiber;
+
+	fiber* mMainFiber = NULL;
+	fiber* mCurrentFiber = NULL;
+
+	void runEntry(fiber* currentFiber)
+	{
+		currentFiber->entry(currentFiber->param);
+		currentFiber->finished = true;
+
+		// Returning would end the thread, so park here until destroyed
+		while (true)
+		{
+			fiberBackend::switchTo(mMainFiber);
+		}
+	}
+
+#if defined(_XBOX)
+	VOID WINAPI fiberStart(LPVOID param)
+	{
+		runEntry((fiber*)param);
+	}
+#else
+	// makecontext only passes int arguments, the fiber being started is
+	// always the one switchTo just made current
+	void fiberStart()
+	{
+		runEntry(mCurrentFiber);
+	}
+#endif
+}
+
+bool fiberBackend::initThread()
+{
+	if (mMainFiber != NULL)
+	{
+		return true;
+	}
+
+	fiber* mainFiber = (fiber*)malloc(sizeof(fiber));
+	memset(mainFiber, 0, sizeof(fiber));
+#if defined(_XBOX)
+	mainFiber->handle = ConvertThreadToFiber(NULL);
+	if (mainFiber->handle == NULL)
+	{
+		free(mainFiber);
+		return false;
+	}
+#endif
+	mMainFiber = mainFiber;
+	mCurrentFiber = mainFiber;
+	return true;
+}
+
+void* fiberBackend::create(uint32_t stackSize, fiberEntry entry, void* param)
+{
+	if (mMainFiber == NULL)
+	{
+		return NULL;
+	}
+
+	fiber* newFiber = (fiber*)malloc(sizeof(fiber));
+	memset(newFiber, 0, sizeof(fiber));
+	newFiber->entry = entry;
+	newFiber->param = param;
+
+#if defined(_XBOX)
+	newFiber->handle = CreateFiber(stackSize, fiberStart, newFiber);
+	if (newFiber->handle == NULL)
+	{
+		free(newFiber);
+		return NULL;
+	}
+#else
+	newFiber->stack = malloc(stackSize);
+	if (newFiber->stack == NULL || getcontext(&newFiber->context) != 0)
+	{
+		free(newFiber->stack);
+		free(newFiber);
+		return NULL;
+	}
+	newFiber->context.uc_stack.ss_sp = newFiber->stack;
+	newFiber->context.uc_stack.ss_size = stackSize;
+	newFiber->context.uc_link = NULL;
+	makecontext(&newFiber->context, fiberStart, 0);
+#endif
+	return newFiber;
+}
+
+void fiberBackend::switchTo(void* target)
+{
+	fiber* targetFiber = (fiber*)target;
+	if (targetFiber == NULL || targetFiber == mCurrentFiber)
+	{
+		return;
+	}
+
+#if defined(_XBOX)
+	mCurrentFiber = targetFiber;
+	SwitchToFiber(targetFiber->handle);
+#else
+	fiber* previousFiber = mCurrentFiber;
+	mCurrentFiber = targetFiber;
+	swapcontext(&previousFiber->context, &targetFiber->context);
+#endif
+}
+
+void fiberBackend::destroy(void* target)
+{
+	fiber* targetFiber = (fiber*)target;
+	if (targetFiber == NULL || targetFiber == mMainFiber || targetFiber == mCurrentFiber)
+	{
+		return;
+	}
+
+#if defined(_XBOX)
+	DeleteFiber(targetFiber->handle);
+#else
+	free(targetFiber->stack);
+#endif
+	free(targetFiber);
+}
+
+bool fiberBackend::isFinished(void* target)
+{
+	return ((fiber*)target)->finished;
+}
+
+void* fiberBackend::getMainFiber()
+{
+	return mMainFiber;
+}
+
+void* fiberBackend::getCurrentFiber()
+{
+	return mCurrentFiber;
+}
+
+double fiberBackend::getMilliseconds()
+{
+#if defined(_XBOX)
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
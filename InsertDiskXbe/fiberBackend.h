@@ -0,0 +1,30 @@
+#pragma once
+
+// Kept free of xtl.h outside of _XBOX so the fiber scheduler can be built
+// and exercised on Linux on top of ucontext.
+#if defined(_XBOX)
+#include "xboxinternals.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+typedef void (*fiberEntry)(void* param);
+
+class fiberBackend
+{
+public:
+
+	// initThread converts the calling thread into the main fiber, it must
+	// be called once before any other fiber is created or switched to.
+	// A fiber whose entry returns is marked finished and switches back to
+	// the main fiber, it must then be destroyed from the main fiber.
+	static bool initThread();
+	static void* create(uint32_t stackSize, fiberEntry entry, void* param);
+	static void switchTo(void* fiber);
+	static void destroy(void* fiber);
+	static bool isFinished(void* fiber);
+	static void* getMainFiber();
+	static void* getCurrentFiber();
+	static double getMilliseconds();
+};
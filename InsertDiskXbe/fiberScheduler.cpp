@@ -0,0 +1,199 @@
+#include "fiberScheduler.h"
+
+#if !defined(_XBOX)
+#include <string.h>
+#endif
+
+namespace
+{
+	typedef struct fiberTask
+	{
+		const char* name;
+		fiberState state;
+		void* fiber;
+		double wakeTime;
+	} fiberTask;
+
+	fiberTask mTasks[FIBER_MAX_TASKS];
+	uint32_t mTaskCount = 0;
+	uint32_t mNextTask = 0;
+	int32_t mCurrentTask = -1;
+	double mBudgetEnd = 0;
+	fiberScheduler::fiberStats mStats = { 0 };
+
+	void switchToMain()
+	{
+		mStats.switches++;
+		fiberBackend::switchTo(fiberBackend::getMainFiber());
+	}
+
+	void resume(int32_t taskId)
+	{
+		fiberTask* task = &mTasks[taskId];
+		mCurrentTask = taskId;
+		mStats.switches++;
+		fiberBackend::switchTo(task->fiber);
+		mCurrentTask = -1;
+
+		if (fiberBackend::isFinished(task->fiber) == true)
+		{
+			fiberBackend::destroy(task->fiber);
+			task->fiber = NULL;
+			task->state = fiberStateDone;
+			mStats.completed++;
+		}
+	}
+}
+
+bool fiberScheduler::init()
+{
+	return fiberBackend::initThread();
+}
+
+int32_t fiberScheduler::spawn(const char* name, fiberEntry entry, void* userData, uint32_t stackSize)
+{
+	if (isInFiber() == true || fiberBackend::initThread() == false)
+	{
+		return -1;
+	}
+
+	// Slots of finished tasks are reused
+	int32_t taskId = -1;
+	for (uint32_t i = 0; i < mTaskCount; i++)
+	{
+		if (mTasks[i].state == fiberStateDone)
+		{
+			taskId = i;
+			break;
+		}
+	}
+	if (taskId < 0)
+	{
+		if (mTaskCount == FIBER_MAX_TASKS)
+		{
+			return -1;
+		}
+		taskId = mTaskCount;
+	}
+
+	void* fiber = fiberBackend::create(stackSize == 0 ? FIBER_DEFAULT_STACK_SIZE : stackSize, entry, userData);
+	if (fiber == NULL)
+	{
+		return -1;
+	}
+
+	fiberTask* task = &mTasks[taskId];
+	memset(task, 0, sizeof(fiberTask));
+	task->name = name;
+	task->state = fiberStateReady;
+	task->fiber = fiber;
+	if ((uint32_t)taskId == mTaskCount)
+	{
+		mTaskCount++;
+	}
+	mStats.spawned++;
+	return taskId;
+}
+
+void fiberScheduler::run(double budgetMilliseconds)
+{
+	if (isInFiber() == true || mTaskCount == 0)
+	{
+		return;
+	}
+
+	double now = fiberBackend::getMilliseconds();
+	mBudgetEnd = now + budgetMilliseconds;
+
+	// Every task gets at most one turn per pass, the pass ends early when
+	// the budget runs out or a full round found nothing to resume.
+	uint32_t idleCount = 0;
+	while (now < mBudgetEnd && idleCount < mTaskCount)
+	{
+		int32_t taskId = mNextTask;
+		mNextTask = (mNextTask + 1) % mTaskCount;
+
+		fiberTask* task = &mTasks[taskId];
+		if (task->state == fiberStateSleeping && now >= task->wakeTime)
+		{
+			task->state = fiberStateReady;
+		}
+		if (task->state != fiberStateReady)
+		{
+			idleCount++;
+			continue;
+		}
+
+		idleCount = 0;
+		resume(taskId);
+		now = fiberBackend::getMilliseconds();
+	}
+
+	if (now >= mBudgetEnd)
+	{
+		mStats.overBudgetFrames++;
+	}
+}
+
+void fiberScheduler::yield()
+{
+	if (isInFiber() == false)
+	{
+		return;
+	}
+	switchToMain();
+}
+
+void fiberScheduler::sleep(uint32_t milliseconds)
+{
+	if (isInFiber() == false)
+	{
+		return;
+	}
+	fiberTask* task = &mTasks[mCurrentTask];
+	task->state = fiberStateSleeping;
+	task->wakeTime = fiberBackend::getMilliseconds() + milliseconds;
+	switchToMain();
+}
+
+bool fiberScheduler::yieldIfOverBudget()
+{
+	if (isInFiber() == false || fiberBackend::getMilliseconds() < mBudgetEnd)
+	{
+		return false;
+	}
+	switchToMain();
+	return true;
+}
+
+bool fiberScheduler::isInFiber()
+{
+	return mCurrentTask >= 0;
+}
+
+bool fiberScheduler::isDone(int32_t taskId)
+{
+	if (taskId < 0 || (uint32_t)taskId >= mTaskCount)
+	{
+		return true;
+	}
+	return mTasks[taskId].state == fiberStateDone;
+}
+
+uint32_t fiberScheduler::getTaskCount()
+{
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < mTaskCount; i++)
+	{
+		if (mTasks[i].state == fiberStateReady || mTasks[i].state == fiberStateSleeping)
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+void fiberScheduler::getStats(fiberStats& stats)
+{
+	stats = mStats;
+}
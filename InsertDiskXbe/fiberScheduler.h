@@ -0,0 +1,41 @@
+#pragma once
+
+#include "fiberBackend.h"
+
+#define FIBER_MAX_TASKS 16
+#define FIBER_DEFAULT_STACK_SIZE (64 * 1024)
+
+typedef enum fiberState
+{
+	fiberStateReady = 0,
+	fiberStateSleeping = 1,
+	fiberStateDone = 2
+} fiberState;
+
+class fiberScheduler
+{
+public:
+
+	typedef struct fiberStats
+	{
+		uint32_t spawned;
+		uint32_t completed;
+		uint32_t switches;
+		uint32_t overBudgetFrames;
+	} fiberStats;
+
+	// Cooperative tasks that share the main thread with the frame tasks.
+	// run resumes ready fibers round robin until budgetMilliseconds is
+	// spent, fibers give the time back through yield, sleep or
+	// yieldIfOverBudget. Only the main fiber may call spawn and run.
+	static bool init();
+	static int32_t spawn(const char* name, fiberEntry entry, void* userData, uint32_t stackSize);
+	static void run(double budgetMilliseconds);
+	static void yield();
+	static void sleep(uint32_t milliseconds);
+	static bool yieldIfOverBudget();
+	static bool isInFiber();
+	static bool isDone(int32_t taskId);
+	static uint32_t getTaskCount();
+	static void getStats(fiberStats& stats);
+};
@@ -175,6 +175,42 @@ pointerVector* fileSystem::fileGetFileInfoDetails(const char* path)
 	return fileInfoDetails;
 }
 
+pointerVector* fileSystem::fileGetDirectoryEntries(const char* path)
+{
+	pointerVector* fileInfoDetails = new pointerVector(true);
+
+	WIN32_FIND_DATAA findData;
+
+	char* searchPath = combinePath(path, "*");
+	HANDLE findHandle = FindFirstFileA(searchPath, &findData);
+	free(searchPath);
+	if (findHandle == INVALID_HANDLE_VALUE) 
+	{     
+		return fileInfoDetails;
+	} 
+
+	// Unlike fileGetFileInfoDetails only what the directory listing itself
+	// returns is used, no per entry attribute, open or time queries.
+	do 
+	{ 
+		if (strcmp(findData.cFileName, ".") == 0 || strcmp(findData.cFileName, "..") == 0)
+		{
+			continue;
+		}
+
+		FileInfoDetail* fileInfoDetail = new FileInfoDetail();
+		fileInfoDetail->path = combinePath(path, findData.cFileName);
+		fileInfoDetail->isDirectory = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		fileInfoDetail->isFile = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+		fileInfoDetail->size = findData.nFileSizeLow;
+		fileInfoDetails->add(fileInfoDetail);			
+	} 
+	while (FindNextFile(findHandle, &findData)); 
+	FindClose(findHandle);
+
+	return fileInfoDetails;
+}
+
 bool fileSystem::fileOpen(const char* path, FileMode const fileMode, uint32_t& fileHandle)
 {
 	char* access = "";
@@ -66,6 +66,7 @@ public:
 	
 	static FileInfoDetail* fileGetFileInfoDetail(const char* path);
 	static pointerVector* fileGetFileInfoDetails(const char* path);
+	static pointerVector* fileGetDirectoryEntries(const char* path);
 	
 	static bool fileOpen(const char* path, FileMode const fileMode, uint32_t& fileHandle);
 	static bool fileRead(uint32_t fileHandle, char* readBuffer, uint32_t const bytesToRead, uint32_t& bytesRead);
@@ -0,0 +1,340 @@
+#include "hashUtility.h"
+#include "stringUtility.h"
+
+#include <string.h>
+
+// Only verify mode hashes, see sectionLoader
+#pragma code_seg("HASH")
+#pragma const_seg("HASH_RD")
+
+#define ROTATE_LEFT(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
+
+namespace
+{
+	uint32_t mCrc32Table[256];
+	bool mCrc32TableBuilt = false;
+
+	const uint32_t mMd5Shifts[64] =
+	{
+		7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+		5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+		4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+		6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+	};
+
+	const uint32_t mMd5Constants[64] =
+	{
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+	};
+
+	void buildCrc32Table()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t value = i;
+			for (uint32_t j = 0; j < 8; j++)
+			{
+				value = (value & 1) != 0 ? (value >> 1) ^ 0xedb88320 : value >> 1;
+			}
+			mCrc32Table[i] = value;
+		}
+		mCrc32TableBuilt = true;
+	}
+
+	void md5Transform(uint32_t* state, const uint8_t* block)
+	{
+		uint32_t words[16];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			words[i] = (uint32_t)block[i * 4] | ((uint32_t)block[(i * 4) + 1] << 8) | ((uint32_t)block[(i * 4) + 2] << 16) | ((uint32_t)block[(i * 4) + 3] << 24);
+		}
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			uint32_t f;
+			uint32_t g;
+			if (i < 16)
+			{
+				f = (b & c) | (~b & d);
+				g = i;
+			}
+			else if (i < 32)
+			{
+				f = (d & b) | (~d & c);
+				g = ((i * 5) + 1) & 15;
+			}
+			else if (i < 48)
+			{
+				f = b ^ c ^ d;
+				g = ((i * 3) + 5) & 15;
+			}
+			else
+			{
+				f = c ^ (b | ~d);
+				g = (i * 7) & 15;
+			}
+			uint32_t temp = d;
+			d = c;
+			c = b;
+			b = b + ROTATE_LEFT(a + f + mMd5Constants[i] + words[g], mMd5Shifts[i]);
+			a = temp;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+	}
+
+	void sha1Transform(uint32_t* state, const uint8_t* block)
+	{
+		uint32_t words[80];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			words[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[(i * 4) + 1] << 16) | ((uint32_t)block[(i * 4) + 2] << 8) | (uint32_t)block[(i * 4) + 3];
+		}
+		for (uint32_t i = 16; i < 80; i++)
+		{
+			uint32_t value = words[i - 3] ^ words[i - 8] ^ words[i - 14] ^ words[i - 16];
+			words[i] = ROTATE_LEFT(value, 1);
+		}
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+		for (uint32_t i = 0; i < 80; i++)
+		{
+			uint32_t f;
+			uint32_t k;
+			if (i < 20)
+			{
+				f = (b & c) | (~b & d);
+				k = 0x5a827999;
+			}
+			else if (i < 40)
+			{
+				f = b ^ c ^ d;
+				k = 0x6ed9eba1;
+			}
+			else if (i < 60)
+			{
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8f1bbcdc;
+			}
+			else
+			{
+				f = b ^ c ^ d;
+				k = 0xca62c1d6;
+			}
+			uint32_t temp = ROTATE_LEFT(a, 5) + f + e + k + words[i];
+			e = d;
+			d = c;
+			c = ROTATE_LEFT(b, 30);
+			b = a;
+			a = temp;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+
+	void transformBlock(hashUtility::hashContext& context, const uint8_t* block)
+	{
+		md5Transform(context.md5, block);
+		sha1Transform(context.sha1, block);
+	}
+
+	int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f')
+		{
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F')
+		{
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	const char* parseHex(const char* value, uint8_t* bytes, uint32_t length)
+	{
+		for (uint32_t i = 0; i < length; i++)
+		{
+			int high = hexValue(value[i * 2]);
+			int low = high < 0 ? -1 : hexValue(value[(i * 2) + 1]);
+			if (low < 0)
+			{
+				return NULL;
+			}
+			bytes[i] = (uint8_t)((high << 4) | low);
+		}
+		return value + (length * 2);
+	}
+
+	const char* skipSpaces(const char* value)
+	{
+		while (*value == ' ' || *value == '\t')
+		{
+			value++;
+		}
+		return value;
+	}
+}
+
+void hashUtility::init(hashContext& context)
+{
+	if (mCrc32TableBuilt == false)
+	{
+		buildCrc32Table();
+	}
+
+	memset(&context, 0, sizeof(hashContext));
+	context.crc32 = 0xffffffff;
+	context.md5[0] = 0x67452301;
+	context.md5[1] = 0xefcdab89;
+	context.md5[2] = 0x98badcfe;
+	context.md5[3] = 0x10325476;
+	context.sha1[0] = 0x67452301;
+	context.sha1[1] = 0xefcdab89;
+	context.sha1[2] = 0x98badcfe;
+	context.sha1[3] = 0x10325476;
+	context.sha1[4] = 0xc3d2e1f0;
+}
+
+void hashUtility::update(hashContext& context, const uint8_t* data, uint32_t length)
+{
+	uint32_t crc32 = context.crc32;
+	for (uint32_t i = 0; i < length; i++)
+	{
+		crc32 = mCrc32Table[(crc32 ^ data[i]) & 0xff] ^ (crc32 >> 8);
+	}
+	context.crc32 = crc32;
+
+	uint32_t used = context.lengthLow & 63;
+	context.lengthLow += length;
+	if (context.lengthLow < length)
+	{
+		context.lengthHigh++;
+	}
+
+	if (used > 0)
+	{
+		uint32_t fill = min(64 - used, length);
+		memcpy(context.block + used, data, fill);
+		data += fill;
+		length -= fill;
+		if (used + fill < 64)
+		{
+			return;
+		}
+		transformBlock(context, context.block);
+	}
+
+	// Whole blocks are hashed in place without copying
+	while (length >= 64)
+	{
+		transformBlock(context, data);
+		data += 64;
+		length -= 64;
+	}
+	memcpy(context.block, data, length);
+}
+
+void hashUtility::final(hashContext& context, hashResult& result)
+{
+	uint32_t bitsLow = context.lengthLow << 3;
+	uint32_t bitsHigh = (context.lengthHigh << 3) | (context.lengthLow >> 29);
+
+	uint32_t used = context.lengthLow & 63;
+	context.block[used++] = 0x80;
+	if (used > 56)
+	{
+		memset(context.block + used, 0, 64 - used);
+		transformBlock(context, context.block);
+		used = 0;
+	}
+	memset(context.block + used, 0, 56 - used);
+
+	// MD5 takes the bit length little endian, SHA-1 big endian
+	uint8_t md5Block[64];
+	memcpy(md5Block, context.block, 56);
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		md5Block[56 + i] = (uint8_t)(bitsLow >> (i * 8));
+		md5Block[60 + i] = (uint8_t)(bitsHigh >> (i * 8));
+		context.block[59 - i] = (uint8_t)(bitsHigh >> (i * 8));
+		context.block[63 - i] = (uint8_t)(bitsLow >> (i * 8));
+	}
+	md5Transform(context.md5, md5Block);
+	sha1Transform(context.sha1, context.block);
+
+	result.crc32 = context.crc32 ^ 0xffffffff;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		result.md5[i] = (uint8_t)(context.md5[i / 4] >> ((i % 4) * 8));
+	}
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		result.sha1[i] = (uint8_t)(context.sha1[i / 4] >> ((3 - (i % 4)) * 8));
+	}
+}
+
+bool hashUtility::equals(const hashResult& result1, const hashResult& result2)
+{
+	return result1.crc32 == result2.crc32 && memcmp(result1.md5, result2.md5, sizeof(result1.md5)) == 0 && memcmp(result1.sha1, result2.sha1, sizeof(result1.sha1)) == 0;
+}
+
+char* hashUtility::formatResult(const hashResult& result)
+{
+	char md5[33];
+	char sha1[41];
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		sprintf(md5 + (i * 2), "%02x", result.md5[i]);
+	}
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		sprintf(sha1 + (i * 2), "%02x", result.sha1[i]);
+	}
+	return stringUtility::formatString("%08x %s %s", result.crc32, md5, sha1);
+}
+
+bool hashUtility::parseResult(const char* value, hashResult& result)
+{
+	uint8_t crc32[4];
+	value = parseHex(skipSpaces(value), crc32, 4);
+	if (value == NULL)
+	{
+		return false;
+	}
+	result.crc32 = ((uint32_t)crc32[0] << 24) | ((uint32_t)crc32[1] << 16) | ((uint32_t)crc32[2] << 8) | (uint32_t)crc32[3];
+
+	value = parseHex(skipSpaces(value), result.md5, 16);
+	if (value == NULL)
+	{
+		return false;
+	}
+	return parseHex(skipSpaces(value), result.sha1, 20) != NULL;
+}
+
+#pragma const_seg()
+#pragma code_seg()
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+class hashUtility
+{
+public:
+
+	// MD5 and SHA-1 both consume 64 byte blocks so one buffered block and
+	// length feed both, CRC32 is updated straight from the input.
+	typedef struct hashContext
+	{
+		uint32_t crc32;
+		uint32_t md5[4];
+		uint32_t sha1[5];
+		uint32_t lengthLow;
+		uint32_t lengthHigh;
+		uint8_t block[64];
+	} hashContext;
+
+	typedef struct hashResult
+	{
+		uint32_t crc32;
+		uint8_t md5[16];
+		uint8_t sha1[20];
+	} hashResult;
+
+	static void init(hashContext& context);
+	static void update(hashContext& context, const uint8_t* data, uint32_t length);
+	static void final(hashContext& context, hashResult& result);
+	static bool equals(const hashResult& result1, const hashResult& result2);
+
+	// Text form is "crc32 md5 sha1" in lower case hex
+	static char* formatResult(const hashResult& result);
+	static bool parseResult(const char* value, hashResult& result);
+};
@@ -0,0 +1,161 @@
+#include "headlessCommandBackend.h"
+
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 0x811c9dc5
+#define FNV_PRIME 0x01000193
+
+headlessCommandBackend::headlessCommandBackend()
+{
+	reset();
+}
+
+void headlessCommandBackend::reset()
+{
+	memset(&mStats, 0, sizeof(mStats));
+	mFrameDraws = 0;
+	mFramePrimitives = 0;
+	mFrameHash = FNV_OFFSET_BASIS;
+	mHandleCount = 0;
+}
+
+void headlessCommandBackend::getStats(headlessStats& stats)
+{
+	stats = mStats;
+}
+
+void headlessCommandBackend::beginCommand(commandOp op)
+{
+	mStats.commands++;
+	mStats.opCounts[op]++;
+	hash((uint32_t)op);
+}
+
+// FNV-1a over the dword's bytes, low byte first on every host
+void headlessCommandBackend::hash(uint32_t value)
+{
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		mFrameHash ^= (value >> (i * 8)) & 0xff;
+		mFrameHash *= FNV_PRIME;
+	}
+}
+
+// NULL stays 0, the rest count up from 1 in first use order
+uint32_t headlessCommandBackend::mapHandle(uint32_t handle)
+{
+	if (handle == 0)
+	{
+		return 0;
+	}
+	for (uint32_t i = 0; i < mHandleCount; i++)
+	{
+		if (mHandles[i] == handle)
+		{
+			return i + 1;
+		}
+	}
+	if (mHandleCount == HEADLESS_MAX_HANDLES)
+	{
+		return 0xffffffff;
+	}
+	mHandles[mHandleCount++] = handle;
+	return mHandleCount;
+}
+
+void headlessCommandBackend::setRenderState(uint32_t state, uint32_t value)
+{
+	beginCommand(commandOpSetRenderState);
+	hash(state);
+	hash(value);
+}
+
+void headlessCommandBackend::setTextureStageState(uint32_t stage, uint32_t type, uint32_t value)
+{
+	beginCommand(commandOpSetTextureStageState);
+	hash(stage);
+	hash(type);
+	hash(value);
+}
+
+void headlessCommandBackend::setTexture(uint32_t stage, uint32_t texture)
+{
+	beginCommand(commandOpSetTexture);
+	hash(stage);
+	hash(mapHandle(texture));
+}
+
+void headlessCommandBackend::setVertexShader(uint32_t handle)
+{
+	beginCommand(commandOpSetVertexShader);
+	hash(handle);
+}
+
+void headlessCommandBackend::setTransform(uint32_t state, const float* matrix)
+{
+	beginCommand(commandOpSetTransform);
+	hash(state);
+	for (uint32_t i = 0; i < COMMAND_TRANSFORM_FLOATS; i++)
+	{
+		uint32_t value;
+		memcpy(&value, &matrix[i], sizeof(value));
+		hash(value);
+	}
+}
+
+void headlessCommandBackend::setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride)
+{
+	beginCommand(commandOpSetStreamSource);
+	hash(stream);
+	hash(mapHandle(vertexBuffer));
+	hash(stride);
+}
+
+void headlessCommandBackend::setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex)
+{
+	beginCommand(commandOpSetIndices);
+	hash(mapHandle(indexBuffer));
+}
+
+void headlessCommandBackend::setVertices(uint32_t vertexCount, uint32_t stride, const uint8_t* vertices)
+{
+	beginCommand(commandOpSetVertices);
+	hash(vertexCount);
+	hash(stride);
+	uint32_t bytes = vertexCount * stride;
+	for (uint32_t i = 0; i < bytes; i++)
+	{
+		mFrameHash ^= vertices[i];
+		mFrameHash *= FNV_PRIME;
+	}
+	mStats.recordedVertices += vertexCount;
+	mStats.vertexBytes += bytes;
+}
+
+void headlessCommandBackend::drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount)
+{
+	beginCommand(commandOpDrawIndexed);
+	hash(primitiveType);
+	hash(minIndex);
+	hash(vertexCount);
+	hash(startIndex);
+	hash(primitiveCount);
+	mStats.draws++;
+	mStats.primitives += primitiveCount;
+	mStats.vertices += vertexCount;
+	mFrameDraws++;
+	mFramePrimitives += primitiveCount;
+}
+
+void headlessCommandBackend::endFrame()
+{
+	beginCommand(commandOpEndFrame);
+	mStats.frames++;
+	mStats.lastFrameDraws = mFrameDraws;
+	mStats.lastFramePrimitives = mFramePrimitives;
+	mStats.lastFrameHash = mFrameHash;
+	mFrameDraws = 0;
+	mFramePrimitives = 0;
+	mFrameHash = FNV_OFFSET_BASIS;
+	mHandleCount = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "commandList.h"
+
+#define HEADLESS_MAX_HANDLES 64
+
+// Counts and hashes commands instead of drawing them. Handles are hashed
+// as the order they were first seen in within the frame, not their value,
+// so frames recorded by different builds hash the same when they draw the
+// same. Vertex contents are hashed from the copies set vertices carries,
+// the base vertex is only where they sat in the ring and is left out.
+class headlessCommandBackend : public commandBackend
+{
+public:
+
+	typedef struct headlessStats
+	{
+		uint32_t frames;
+		uint32_t commands;
+		uint32_t opCounts[commandOpCount];
+		uint32_t draws;
+		uint32_t primitives;
+		uint32_t vertices;
+		uint32_t recordedVertices;
+		uint32_t vertexBytes;
+		uint32_t lastFrameDraws;
+		uint32_t lastFramePrimitives;
+		uint32_t lastFrameHash;
+	} headlessStats;
+
+	headlessCommandBackend();
+	void reset();
+	void getStats(headlessStats& stats);
+
+	virtual void setRenderState(uint32_t state, uint32_t value);
+	virtual void setTextureStageState(uint32_t stage, uint32_t type, uint32_t value);
+	virtual void setTexture(uint32_t stage, uint32_t texture);
+	virtual void setVertexShader(uint32_t handle);
+	virtual void setTransform(uint32_t state, const float* matrix);
+	virtual void setStreamSource(uint32_t stream, uint32_t vertexBuffer, uint32_t stride);
+	virtual void setIndices(uint32_t indexBuffer, uint32_t baseVertexIndex);
+	virtual void setVertices(uint32_t vertexCount, uint32_t stride, const uint8_t* vertices);
+	virtual void drawIndexed(uint32_t primitiveType, uint32_t minIndex, uint32_t vertexCount, uint32_t startIndex, uint32_t primitiveCount);
+	virtual void endFrame();
+
+private:
+
+	void beginCommand(commandOp op);
+	void hash(uint32_t value);
+	uint32_t mapHandle(uint32_t handle);
+
+	headlessStats mStats;
+	uint32_t mFrameDraws;
+	uint32_t mFramePrimitives;
+	uint32_t mFrameHash;
+	uint32_t mHandles[HEADLESS_MAX_HANDLES];
+	uint32_t mHandleCount;
+};
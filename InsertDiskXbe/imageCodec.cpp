@@ -0,0 +1,26 @@
+#include "xboxinternals.h"
+
+// CRT headers come first so their inline functions stay in the preloaded
+// image, only the stb code below moves to the on demand section.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+
+// Loaded through sectionLoader, sectionGroupImageCodec
+#pragma code_seg("IMGC")
+#pragma const_seg("IMGC_RD")
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ASSERT(x)
+#include "stb_image.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#pragma const_seg()
+#pragma code_seg()
@@ -0,0 +1,204 @@
+#include "inputManager.h"
+
+namespace
+{
+	const WORD mDigitalButtons[] =
+	{
+		XINPUT_GAMEPAD_DPAD_UP,
+		XINPUT_GAMEPAD_DPAD_DOWN,
+		XINPUT_GAMEPAD_DPAD_LEFT,
+		XINPUT_GAMEPAD_DPAD_RIGHT,
+		XINPUT_GAMEPAD_START,
+		XINPUT_GAMEPAD_BACK,
+		XINPUT_GAMEPAD_LEFT_THUMB,
+		XINPUT_GAMEPAD_RIGHT_THUMB
+	};
+
+	const char* mButtonNames[inputButtonCount] =
+	{
+		"A", "B", "X", "Y", "Black", "White", "Left trigger", "Right trigger",
+		"Dpad up", "Dpad down", "Dpad left", "Dpad right", "Start", "Back", "Left thumb", "Right thumb"
+	};
+
+	bool mInitialized = false;
+	HANDLE mGamepads[INPUT_MAX_PORTS];
+	uint32_t mButtonStates[INPUT_MAX_PORTS];
+	DWORD mPacketNumbers[INPUT_MAX_PORTS];
+
+	// Filled and drained on the main thread only
+	inputManager::inputEvent mQueue[INPUT_QUEUE_SIZE];
+	uint32_t mQueueHead = 0;
+	uint32_t mQueueCount = 0;
+	uint32_t mDroppedEvents = 0;
+
+	void queueEvent(uint32_t port, uint32_t button, bool pressed, uint32_t time)
+	{
+		if (mQueueCount == INPUT_QUEUE_SIZE)
+		{
+			mDroppedEvents++;
+			return;
+		}
+		inputManager::inputEvent* event = &mQueue[(mQueueHead + mQueueCount) % INPUT_QUEUE_SIZE];
+		event->port = port;
+		event->button = (inputButton)button;
+		event->pressed = pressed;
+		event->time = time;
+		mQueueCount++;
+	}
+
+	uint32_t getButtonState(const XINPUT_GAMEPAD& gamepad)
+	{
+		uint32_t buttonState = 0;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			if (gamepad.bAnalogButtons[i] > INPUT_ANALOG_THRESHOLD)
+			{
+				buttonState |= 1 << (inputButtonA + i);
+			}
+		}
+		for (uint32_t i = 0; i < sizeof(mDigitalButtons) / sizeof(mDigitalButtons[0]); i++)
+		{
+			if ((gamepad.wButtons & mDigitalButtons[i]) != 0)
+			{
+				buttonState |= 1 << (inputButtonDpadUp + i);
+			}
+		}
+		return buttonState;
+	}
+
+	void closePort(uint32_t port, uint32_t time)
+	{
+		XInputClose(mGamepads[port]);
+		mGamepads[port] = NULL;
+
+		// Held buttons are released so nothing stays stuck down on unplug
+		for (uint32_t i = 0; i < inputButtonCount; i++)
+		{
+			if ((mButtonStates[port] & (1 << i)) != 0)
+			{
+				queueEvent(port, i, false, time);
+			}
+		}
+		mButtonStates[port] = 0;
+	}
+
+	void updateDevices(uint32_t time)
+	{
+		DWORD insertions = 0;
+		DWORD removals = 0;
+		if (XGetDeviceChanges(XDEVICE_TYPE_GAMEPAD, &insertions, &removals) == FALSE)
+		{
+			return;
+		}
+
+		for (uint32_t port = 0; port < INPUT_MAX_PORTS; port++)
+		{
+			if ((removals & (1 << port)) != 0 && mGamepads[port] != NULL)
+			{
+				closePort(port, time);
+			}
+			if ((insertions & (1 << port)) != 0 && mGamepads[port] == NULL)
+			{
+				mGamepads[port] = XInputOpen(XDEVICE_TYPE_GAMEPAD, port, XDEVICE_NO_SLOT, NULL);
+				mPacketNumbers[port] = 0;
+			}
+		}
+	}
+}
+
+void inputManager::init()
+{
+	if (mInitialized == true)
+	{
+		return;
+	}
+	mInitialized = true;
+
+	memset(mGamepads, 0, sizeof(mGamepads));
+	memset(mButtonStates, 0, sizeof(mButtonStates));
+	memset(mPacketNumbers, 0, sizeof(mPacketNumbers));
+
+	XInitDevices(0, NULL);
+
+	DWORD devices = XGetDevices(XDEVICE_TYPE_GAMEPAD);
+	for (uint32_t port = 0; port < INPUT_MAX_PORTS; port++)
+	{
+		if ((devices & (1 << port)) != 0)
+		{
+			mGamepads[port] = XInputOpen(XDEVICE_TYPE_GAMEPAD, port, XDEVICE_NO_SLOT, NULL);
+		}
+	}
+}
+
+void inputManager::update()
+{
+	uint32_t time = GetTickCount();
+	updateDevices(time);
+
+	for (uint32_t port = 0; port < INPUT_MAX_PORTS; port++)
+	{
+		if (mGamepads[port] == NULL)
+		{
+			continue;
+		}
+
+		XINPUT_STATE inputState;
+		if (XInputGetState(mGamepads[port], &inputState) != ERROR_SUCCESS)
+		{
+			continue;
+		}
+
+		// An unchanged packet number means nothing moved since the last vblank
+		if (inputState.dwPacketNumber == mPacketNumbers[port])
+		{
+			continue;
+		}
+		mPacketNumbers[port] = inputState.dwPacketNumber;
+
+		uint32_t buttonState = getButtonState(inputState.Gamepad);
+		uint32_t changed = buttonState ^ mButtonStates[port];
+		for (uint32_t i = 0; changed != 0 && i < inputButtonCount; i++)
+		{
+			if ((changed & (1 << i)) != 0)
+			{
+				queueEvent(port, i, (buttonState & (1 << i)) != 0, time);
+			}
+		}
+		mButtonStates[port] = buttonState;
+	}
+}
+
+bool inputManager::pollEvent(inputEvent& event)
+{
+	if (mQueueCount == 0)
+	{
+		return false;
+	}
+	event = mQueue[mQueueHead];
+	mQueueHead = (mQueueHead + 1) % INPUT_QUEUE_SIZE;
+	mQueueCount--;
+	return true;
+}
+
+bool inputManager::isButtonDown(uint32_t port, inputButton button)
+{
+	if (port >= INPUT_MAX_PORTS)
+	{
+		return false;
+	}
+	return (mButtonStates[port] & (1 << button)) != 0;
+}
+
+uint32_t inputManager::getDroppedEvents()
+{
+	return mDroppedEvents;
+}
+
+const char* inputManager::getButtonString(inputButton button)
+{
+	if (button >= inputButtonCount)
+	{
+		return "Unknown";
+	}
+	return mButtonNames[button];
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define INPUT_MAX_PORTS 4
+#define INPUT_QUEUE_SIZE 32
+#define INPUT_ANALOG_THRESHOLD 30
+
+typedef enum inputButton
+{
+	inputButtonA = 0,
+	inputButtonB = 1,
+	inputButtonX = 2,
+	inputButtonY = 3,
+	inputButtonBlack = 4,
+	inputButtonWhite = 5,
+	inputButtonLeftTrigger = 6,
+	inputButtonRightTrigger = 7,
+	inputButtonDpadUp = 8,
+	inputButtonDpadDown = 9,
+	inputButtonDpadLeft = 10,
+	inputButtonDpadRight = 11,
+	inputButtonStart = 12,
+	inputButtonBack = 13,
+	inputButtonLeftThumb = 14,
+	inputButtonRightThumb = 15,
+	inputButtonCount = 16
+} inputButton;
+
+class inputManager
+{
+public:
+
+	typedef struct inputEvent
+	{
+		uint32_t port;
+		inputButton button;
+		bool pressed;
+		uint32_t time;
+	} inputEvent;
+
+	// update samples every connected gamepad and queues a press or release
+	// for each button that changed, it is meant to run once per vblank
+	// ahead of the tasks that drain the queue.
+	static void init();
+	static void update();
+	static bool pollEvent(inputEvent& event);
+	static bool isButtonDown(uint32_t port, inputButton button);
+	static uint32_t getDroppedEvents();
+	static const char* getButtonString(inputButton button);
+};
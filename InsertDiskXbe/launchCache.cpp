@@ -0,0 +1,192 @@
+#include "launchCache.h"
+#include "driveManager.h"
+#include "fileSystem.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define LAUNCH_CACHE_DIRECTORY "E:\\InsertDiskXbe"
+#define LAUNCH_CACHE_PATH "E:\\InsertDiskXbe\\launchCache.bin"
+#define LAUNCH_CACHE_MAGIC 0x3148434C
+#define LAUNCH_CACHE_VERSION 1
+
+#define FNV_OFFSET_BASIS ((((uint64_t)0xcbf29ce4) << 32) | 0x84222325)
+#define FNV_PRIME ((((uint64_t)0x00000100) << 32) | 0x000001b3)
+
+namespace
+{
+	typedef struct launchCacheFile
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t sequence;
+		uint32_t hits;
+		uint32_t misses;
+		uint64_t hitMicroseconds;
+		uint64_t missMicroseconds;
+		launchCache::launchCacheEntry entries[LAUNCH_CACHE_MAX_ENTRIES];
+	} launchCacheFile;
+
+	launchCacheFile mCache;
+	bool mLoaded = false;
+
+	uint64_t hashUInt32(uint64_t hash, uint32_t value)
+	{
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+	void resetCache()
+	{
+		memset(&mCache, 0, sizeof(launchCacheFile));
+		mCache.magic = LAUNCH_CACHE_MAGIC;
+		mCache.version = LAUNCH_CACHE_VERSION;
+	}
+}
+
+uint64_t launchCache::computeFingerprint(const xbeHeader::xbeInfo& info)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	hash = hashUInt32(hash, info.titleId);
+	hash = hashUInt32(hash, info.version);
+	hash = hashUInt32(hash, info.diskNumber);
+	hash = hashUInt32(hash, info.timeDate);
+	return hash;
+}
+
+bool launchCache::load()
+{
+	if (mLoaded == true)
+	{
+		return true;
+	}
+
+	resetCache();
+	mLoaded = true;
+
+	driveManager::mountDrive("E");
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(LAUNCH_CACHE_PATH, fileSystem::FileModeRead, fileHandle) == false)
+	{
+		return false;
+	}
+
+	uint32_t bytesRead = 0;
+	bool result = fileSystem::fileRead(fileHandle, (char*)&mCache, sizeof(launchCacheFile), bytesRead);
+	fileSystem::fileClose(fileHandle);
+
+	if (result == false || bytesRead != sizeof(launchCacheFile) || mCache.magic != LAUNCH_CACHE_MAGIC || mCache.version != LAUNCH_CACHE_VERSION || mCache.entryCount > LAUNCH_CACHE_MAX_ENTRIES)
+	{
+		resetCache();
+		return false;
+	}
+	return true;
+}
+
+bool launchCache::save()
+{
+	if (fileSystem::directoryCreate(LAUNCH_CACHE_DIRECTORY) == false)
+	{
+		return false;
+	}
+	uint32_t bytesWritten = 0;
+	return fileSystem::fileWrite(LAUNCH_CACHE_PATH, (char*)&mCache, sizeof(launchCacheFile), bytesWritten);
+}
+
+bool launchCache::lookup(uint64_t fingerprint, launchCacheEntry& entry)
+{
+	load();
+
+	for (uint32_t i = 0; i < mCache.entryCount; i++)
+	{
+		if (mCache.entries[i].fingerprint == fingerprint)
+		{
+			mCache.sequence++;
+			mCache.entries[i].lastUsed = mCache.sequence;
+			entry = mCache.entries[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+void launchCache::store(uint64_t fingerprint, uint32_t titleId, const char* launchPath)
+{
+	load();
+
+	// Replace an existing entry, append, or evict the least recently used one
+	uint32_t index = mCache.entryCount;
+	for (uint32_t i = 0; i < mCache.entryCount; i++)
+	{
+		if (mCache.entries[i].fingerprint == fingerprint)
+		{
+			index = i;
+			break;
+		}
+	}
+	if (index == LAUNCH_CACHE_MAX_ENTRIES)
+	{
+		index = 0;
+		for (uint32_t i = 1; i < mCache.entryCount; i++)
+		{
+			if (mCache.entries[i].lastUsed < mCache.entries[index].lastUsed)
+			{
+				index = i;
+			}
+		}
+	}
+	else if (index == mCache.entryCount)
+	{
+		mCache.entryCount++;
+	}
+
+	mCache.sequence++;
+	launchCacheEntry* entry = &mCache.entries[index];
+	memset(entry, 0, sizeof(launchCacheEntry));
+	entry->fingerprint = fingerprint;
+	entry->titleId = titleId;
+	entry->lastUsed = mCache.sequence;
+	strncpy(entry->launchPath, launchPath, LAUNCH_CACHE_MAX_PATH - 1);
+}
+
+void launchCache::recordHit(double milliseconds)
+{
+	load();
+	mCache.hits++;
+	mCache.hitMicroseconds += (uint64_t)(milliseconds * 1000.0);
+}
+
+void launchCache::recordMiss(double milliseconds)
+{
+	load();
+	mCache.misses++;
+	mCache.missMicroseconds += (uint64_t)(milliseconds * 1000.0);
+}
+
+void launchCache::getStats(launchCacheStats& stats)
+{
+	load();
+	stats.hits = mCache.hits;
+	stats.misses = mCache.misses;
+	stats.hitMilliseconds = mCache.hitMicroseconds / 1000.0;
+	stats.missMilliseconds = mCache.missMicroseconds / 1000.0;
+}
+
+void launchCache::printStats()
+{
+	launchCacheStats stats;
+	getStats(stats);
+
+	uint32_t lookups = stats.hits + stats.misses;
+	double hitRate = lookups == 0 ? 0 : (stats.hits * 100.0) / lookups;
+	double averageHit = stats.hits == 0 ? 0 : stats.hitMilliseconds / stats.hits;
+	double averageMiss = stats.misses == 0 ? 0 : stats.missMilliseconds / stats.misses;
+	double saved = (stats.hits == 0 || stats.misses == 0) ? 0 : averageMiss - averageHit;
+	utils::debugPrint("Launch cache: %u hits, %u misses (%.1f%% hit rate), hit %.2fms, miss %.2fms, saved %.2fms per cached launch\n", stats.hits, stats.misses, hitRate, averageHit, averageMiss, saved);
+}
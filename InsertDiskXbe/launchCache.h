@@ -0,0 +1,38 @@
+#pragma once
+
+#include "xboxinternals.h"
+#include "xbeHeader.h"
+
+#define LAUNCH_CACHE_MAX_ENTRIES 64
+#define LAUNCH_CACHE_MAX_PATH 128
+
+class launchCache
+{
+public:
+
+	typedef struct launchCacheEntry
+	{
+		uint64_t fingerprint;
+		uint32_t titleId;
+		uint32_t lastUsed;
+		char launchPath[LAUNCH_CACHE_MAX_PATH];
+	} launchCacheEntry;
+
+	typedef struct launchCacheStats
+	{
+		uint32_t hits;
+		uint32_t misses;
+		double hitMilliseconds;
+		double missMilliseconds;
+	} launchCacheStats;
+
+	static uint64_t computeFingerprint(const xbeHeader::xbeInfo& info);
+	static bool load();
+	static bool save();
+	static bool lookup(uint64_t fingerprint, launchCacheEntry& entry);
+	static void store(uint64_t fingerprint, uint32_t titleId, const char* launchPath);
+	static void recordHit(double milliseconds);
+	static void recordMiss(double milliseconds);
+	static void getStats(launchCacheStats& stats);
+	static void printStats();
+};
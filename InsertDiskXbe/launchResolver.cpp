@@ -0,0 +1,87 @@
+#include "launchResolver.h"
+#include "fileSystem.h"
+#include "stringUtility.h"
+
+namespace
+{
+	fileSystem::FileInfoDetail* findEntry(pointerVector* entries, const char* name, bool isDirectory)
+	{
+		for (uint32_t i = 0; i < entries->count(); i++)
+		{
+			fileSystem::FileInfoDetail* entry = (fileSystem::FileInfoDetail*)entries->get(i);
+			if (entry->isDirectory != isDirectory)
+			{
+				continue;
+			}
+			char* entryName = fileSystem::getFileName(entry->path);
+			bool found = stringUtility::equals(entryName, name, true);
+			free(entryName);
+			if (found == true)
+			{
+				return entry;
+			}
+		}
+		return NULL;
+	}
+
+	void addTarget(pointerVector* targets, const char* rootPath, const char* folder, const char* fileName, bool confirmed)
+	{
+		char* folderPath = fileSystem::combinePath(rootPath, folder);
+
+		launchResolver::launchTarget* target = new launchResolver::launchTarget();
+		target->xbePath = fileSystem::combinePath(folderPath, fileName);
+		target->launchPath = stringUtility::formatString("%s%s;%s", folderPath, strlen(folder) == 0 ? "\\" : "", fileName);
+		target->confirmed = confirmed;
+		targets->add(target);
+
+		free(folderPath);
+	}
+}
+
+pointerVector* launchResolver::resolve(const char* rootPath, const char** candidates, uint32_t candidateCount)
+{
+	pointerVector* targets = new pointerVector(true);
+
+	pointerVector* entries = fileSystem::fileGetDirectoryEntries(rootPath);
+	for (uint32_t i = 0; i < candidateCount; i++)
+	{
+		const char* candidate = candidates[i];
+		char* folder = fileSystem::getDirectory(candidate);
+		char* fileName = fileSystem::getFileName(candidate);
+
+		if (strlen(folder) == 0)
+		{
+			fileSystem::FileInfoDetail* entry = findEntry(entries, fileName, false);
+			if (entry != NULL)
+			{
+				char* entryName = fileSystem::getFileName(entry->path);
+				addTarget(targets, rootPath, "", entryName, true);
+				free(entryName);
+			}
+		}
+		else if (stringUtility::equals(folder, "*", false) == true)
+		{
+			for (uint32_t j = 0; j < entries->count(); j++)
+			{
+				fileSystem::FileInfoDetail* entry = (fileSystem::FileInfoDetail*)entries->get(j);
+				if (entry->isDirectory == false)
+				{
+					continue;
+				}
+				char* entryName = fileSystem::getFileName(entry->path);
+				addTarget(targets, rootPath, entryName, fileName, false);
+				free(entryName);
+			}
+		}
+		else if (findEntry(entries, folder, true) != NULL)
+		{
+			addTarget(targets, rootPath, folder, fileName, false);
+		}
+
+		free(fileName);
+		free(folder);
+	}
+	delete(entries);
+
+	return targets;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "xboxinternals.h"
+#include "pointerVector.h"
+
+class launchResolver
+{
+public:
+
+	typedef struct launchTarget
+	{
+		char* xbePath;
+		char* launchPath;
+		bool confirmed;
+
+		launchTarget() : xbePath(NULL), launchPath(NULL), confirmed(false) {}
+
+		~launchTarget()
+		{
+			free(xbePath);
+			free(launchPath);
+		}
+
+	} launchTarget;
+
+	// Candidates are relative to the root, either "file.xbe", "folder\file.xbe"
+	// or "*\file.xbe" for every folder in the root. Root files are confirmed by
+	// the listing, files inside folders still need opening to be confirmed.
+	static pointerVector* resolve(const char* rootPath, const char** candidates, uint32_t candidateCount);
+};
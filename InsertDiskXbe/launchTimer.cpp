@@ -0,0 +1,239 @@
+#include "launchTimer.h"
+#include "driveManager.h"
+#include "fileSystem.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LAUNCH_TIMER_MAX_SAMPLES 128
+#define LAUNCH_TIMER_DIRECTORY "E:\\InsertDiskXbe"
+#define LAUNCH_TIMER_PATH "E:\\InsertDiskXbe\\launchTimer.bin"
+#define LAUNCH_TIMER_MAGIC 0x314D544C
+#define LAUNCH_TIMER_VERSION 1
+
+namespace
+{
+	const char* mPhaseNames[launchPhaseCount] =
+	{
+		"Tray closed",
+		"Media detected",
+		"D: mounted",
+		"XBE probed",
+		"Launch data filled",
+		"Firmware return"
+	};
+
+	typedef struct sampleSet
+	{
+		double values[LAUNCH_TIMER_MAX_SAMPLES];
+		uint32_t count;
+		uint32_t next;
+	} sampleSet;
+
+	typedef struct launchTimerFile
+	{
+		uint32_t magic;
+		uint32_t version;
+		// Index 0 holds the total from the first to the last mark, every other
+		// index holds the time spent reaching that phase from the previous one.
+		sampleSet samples[launchPhaseCount];
+	} launchTimerFile;
+
+	uint64_t mMarks[launchPhaseCount];
+	bool mMarked[launchPhaseCount];
+
+	// Kept on E: so the stats cover every launch, not just this boot
+	launchTimerFile mHistory;
+	bool mLoaded = false;
+
+	void resetHistory()
+	{
+		memset(&mHistory, 0, sizeof(launchTimerFile));
+		mHistory.magic = LAUNCH_TIMER_MAGIC;
+		mHistory.version = LAUNCH_TIMER_VERSION;
+	}
+
+	bool validHistory()
+	{
+		if (mHistory.magic != LAUNCH_TIMER_MAGIC || mHistory.version != LAUNCH_TIMER_VERSION)
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < launchPhaseCount; i++)
+		{
+			if (mHistory.samples[i].count > LAUNCH_TIMER_MAX_SAMPLES || mHistory.samples[i].next >= LAUNCH_TIMER_MAX_SAMPLES)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void addSample(sampleSet& samples, double value)
+	{
+		samples.values[samples.next] = value;
+		samples.next = (samples.next + 1) % LAUNCH_TIMER_MAX_SAMPLES;
+		if (samples.count < LAUNCH_TIMER_MAX_SAMPLES)
+		{
+			samples.count++;
+		}
+	}
+
+	int compareSamples(const void* a, const void* b)
+	{
+		double value1 = *(const double*)a;
+		double value2 = *(const double*)b;
+		return value1 < value2 ? -1 : (value1 > value2 ? 1 : 0);
+	}
+
+	bool calculateStats(const sampleSet& samples, launchTimer::phaseStats& stats)
+	{
+		memset(&stats, 0, sizeof(stats));
+		if (samples.count == 0)
+		{
+			return false;
+		}
+
+		double sorted[LAUNCH_TIMER_MAX_SAMPLES];
+		memcpy(sorted, samples.values, samples.count * sizeof(double));
+		qsort(sorted, samples.count, sizeof(double), compareSamples);
+
+		stats.samples = samples.count;
+		stats.min = sorted[0];
+		stats.median = sorted[samples.count / 2];
+		stats.p95 = sorted[((samples.count - 1) * 95) / 100];
+		stats.max = sorted[samples.count - 1];
+		return true;
+	}
+}
+
+bool launchTimer::load()
+{
+	if (mLoaded == true)
+	{
+		return true;
+	}
+
+	resetHistory();
+	mLoaded = true;
+
+	driveManager::mountDrive("E");
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(LAUNCH_TIMER_PATH, fileSystem::FileModeRead, fileHandle) == false)
+	{
+		return false;
+	}
+
+	uint32_t bytesRead = 0;
+	bool result = fileSystem::fileRead(fileHandle, (char*)&mHistory, sizeof(launchTimerFile), bytesRead);
+	fileSystem::fileClose(fileHandle);
+
+	if (result == false || bytesRead != sizeof(launchTimerFile) || validHistory() == false)
+	{
+		resetHistory();
+		return false;
+	}
+	return true;
+}
+
+bool launchTimer::save()
+{
+	if (mLoaded == false)
+	{
+		return false;
+	}
+	if (fileSystem::directoryCreate(LAUNCH_TIMER_DIRECTORY) == false)
+	{
+		return false;
+	}
+	uint32_t bytesWritten = 0;
+	return fileSystem::fileWrite(LAUNCH_TIMER_PATH, (char*)&mHistory, sizeof(launchTimerFile), bytesWritten);
+}
+
+void launchTimer::reset()
+{
+	memset(mMarked, 0, sizeof(mMarked));
+}
+
+void launchTimer::mark(launchPhase phase)
+{
+	mark(phase, utils::getPerformanceCounter());
+}
+
+void launchTimer::mark(launchPhase phase, uint64_t counter)
+{
+	if (mMarked[phase] == true)
+	{
+		return;
+	}
+	mMarks[phase] = counter;
+	mMarked[phase] = true;
+}
+
+bool launchTimer::hasMark(launchPhase phase)
+{
+	return mMarked[phase];
+}
+
+bool launchTimer::commit()
+{
+	// Insertions that were rejected or pulled before launching only tell
+	// us how long it took to give up, so they are not worth a sample
+	if (mMarked[launchPhaseLaunchDataFilled] == false)
+	{
+		reset();
+		return false;
+	}
+
+	load();
+
+	int32_t first = -1;
+	int32_t previous = -1;
+	for (int32_t i = 0; i < launchPhaseCount; i++)
+	{
+		if (mMarked[i] == false)
+		{
+			continue;
+		}
+		if (first < 0)
+		{
+			first = i;
+		}
+		if (previous >= 0)
+		{
+			addSample(mHistory.samples[i], utils::getElapsedMilliseconds(mMarks[previous], mMarks[i]));
+		}
+		previous = i;
+	}
+
+	if (first >= 0 && previous > first)
+	{
+		addSample(mHistory.samples[0], utils::getElapsedMilliseconds(mMarks[first], mMarks[previous]));
+	}
+	reset();
+	return true;
+}
+
+bool launchTimer::getPhaseStats(launchPhase phase, phaseStats& stats)
+{
+	load();
+	return calculateStats(mHistory.samples[phase], stats);
+}
+
+void launchTimer::print()
+{
+	load();
+	utils::debugPrint("Detect to launch latency (ms)\n");
+	utils::debugPrint("%-20s %7s %9s %9s %9s %9s\n", "Phase", "Samples", "Min", "Median", "P95", "Max");
+	for (int32_t i = 0; i < launchPhaseCount; i++)
+	{
+		phaseStats stats;
+		if (calculateStats(mHistory.samples[i], stats) == false)
+		{
+			continue;
+		}
+		utils::debugPrint("%-20s %7u %9.2f %9.2f %9.2f %9.2f\n", i == 0 ? "Total" : mPhaseNames[i], stats.samples, stats.min, stats.median, stats.p95, stats.max);
+	}
+}
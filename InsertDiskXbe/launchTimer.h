@@ -0,0 +1,43 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+typedef enum launchPhase
+{
+	launchPhaseTrayClosed = 0,
+	launchPhaseMediaDetected = 1,
+	launchPhaseDriveMounted = 2,
+	launchPhaseXbeProbed = 3,
+	launchPhaseLaunchDataFilled = 4,
+	launchPhaseFirmwareReturn = 5,
+	launchPhaseCount = 6
+} launchPhase;
+
+class launchTimer
+{
+public:
+
+	typedef struct phaseStats
+	{
+		uint32_t samples;
+		double min;
+		double median;
+		double p95;
+		double max;
+	} phaseStats;
+
+	// Each phase is timed from the previous marked phase, stats for
+	// launchPhaseTrayClosed cover the whole tray closed to launch path.
+	// Samples are kept on E: across boots, load mounts E: on first use.
+	static bool load();
+	static bool save();
+	static void reset();
+	static void mark(launchPhase phase);
+	static void mark(launchPhase phase, uint64_t counter);
+	static bool hasMark(launchPhase phase);
+	// Only records an insertion that reached launchPhaseLaunchDataFilled,
+	// anything else is discarded and false is returned.
+	static bool commit();
+	static bool getPhaseStats(launchPhase phase, phaseStats& stats);
+	static void print();
+};
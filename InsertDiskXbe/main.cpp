@@ -12,9 +12,62 @@
 #include "ssfn.h"
 #include "driveManager.h"
 #include "fileSystem.h"
+#include "trayMonitor.h"
+#include "launchTimer.h"
+#include "scheduler.h"
+#include "launchCache.h"
+#include "trayController.h"
+#include "discWorker.h"
+#include "discProbe.h"
+#include "xbeHeader.h"
+#include "mediaClassifier.h"
+#include "traceRing.h"
+#include "verifyStation.h"
+#include "sessionRecorder.h"
+#include "thermalMonitor.h"
+#include "inputManager.h"
+#include "fiberScheduler.h"
+#include "startupTimeline.h"
+#include "sectionLoader.h"
+#include "spriteBatch.h"
+#include "vertexRing.h"
+#include "quadIndexBuffer.h"
+#include "deviceState.h"
+#include "commandList.h"
+#include "d3dCommandBackend.h"
 
 #define D3DFVF_CUSTOMVERTEX (D3DFVF_XYZ|D3DFVF_TEX1)
 
+#define INPUT_TASK_INTERVAL 1
+#define TRAY_TASK_INTERVAL 1
+#define DRIVE_TASK_INTERVAL 6
+#define RENDER_TASK_INTERVAL 1
+#define VERIFY_TASK_INTERVAL 30
+#define THERMAL_TASK_INTERVAL 300
+#define FIBER_TASK_INTERVAL 1
+
+// Share of each 16.6ms frame handed to fibers ahead of rendering
+#define FIBER_FRAME_BUDGET 4.0
+
+#define INSERT_DISK_MESSAGE "Please Insert Disk To Continue..."
+#define VERIFY_INSERT_DISK_MESSAGE "Verify Mode, Please Insert Disk..."
+#define DRIVE_STALLED_MESSAGE "Drive stalled, please reinsert disc"
+#define REPLAY_COMPLETE_MESSAGE "Session replay complete"
+#define REPLAY_EXHAUSTED_MESSAGE "Session replay has no more probes"
+
+#define TRAY_STALL_TIMEOUT 10000
+
+// Glyphs needed for every fixed status message, the full atlas follows on
+// a fiber. Verify progress is formatted, so its text and digits are listed.
+#define STARTUP_GLYPHS INSERT_DISK_MESSAGE VERIFY_INSERT_DISK_MESSAGE DRIVE_STALLED_MESSAGE REPLAY_COMPLETE_MESSAGE REPLAY_EXHAUSTED_MESSAGE NO_LAUNCH_TARGET_MESSAGE
+#define STARTUP_VERIFY_GLYPHS "Verifying Verified Verify FAILED: files OK at bad, missing, extra MB/s ETA 0123456789.:/"
+#define STARTUP_GLYPHS_SIZE 1024
+#define STARTUP_FONT_TEXTURE_SIZE 256
+
+#define COMMAND_CAPTURE_DIRECTORY "E:\\InsertDiskXbe"
+#define COMMAND_CAPTURE_PATH "E:\\InsertDiskXbe\\frame.cmd"
+#define COMMAND_CAPTURE_FLAG_PATH "E:\\InsertDiskXbe\\capture.flag"
+
 typedef struct {
     DWORD dwWidth;
     DWORD dwHeight;
@@ -54,6 +107,9 @@ DISPLAY_MODE displayModes[] =
 
 #define NUM_MODES (sizeof(displayModes) / sizeof(displayModes[0]))
 
+// Draws recorded by commandList reach the device through this backend
+d3dCommandBackend mD3dCommandBackend;
+
 bool supportsMode(DISPLAY_MODE mode, DWORD dwVideoStandard, DWORD dwVideoFlags)
 {
     if (mode.dwFreq == 60 && !(dwVideoFlags & XC_VIDEO_FLAGS_PAL_60Hz) && (dwVideoStandard == XC_VIDEO_STANDARD_PAL_I))
@@ -83,6 +139,39 @@ bool supportsMode(DISPLAY_MODE mode, DWORD dwVideoStandard, DWORD dwVideoFlags)
     return true;
 }
 
+// State every frame draws with, set once rather than per frame
+void setFixedDeviceState()
+{
+	D3DXMATRIX matProjection;
+	D3DXMatrixOrthoOffCenterLH(&matProjection, 0, (float)context::getBufferWidth(), 0, (float)context::getBufferHeight(), 1.0f, 100.0f);
+	deviceState::setTransform(D3DTS_PROJECTION, &matProjection);
+
+	D3DXMATRIX  matView;
+    D3DXMatrixIdentity(&matView);
+    deviceState::setTransform(D3DTS_VIEW, &matView);
+
+	D3DXMATRIX matWorld;
+	D3DXMatrixIdentity(&matWorld);
+	deviceState::setTransform(D3DTS_WORLD, &matWorld);
+
+	deviceState::setRenderState(D3DRS_LIGHTING, FALSE);
+	deviceState::setVertexShader(D3DFVF_CUSTOMVERTEX);
+	deviceState::setRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
+	deviceState::setRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+	deviceState::setRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+
+	deviceState::setTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+    deviceState::setTextureStageState(0, D3DTSS_COLORARG2, D3DTA_TFACTOR);
+    deviceState::setTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+    deviceState::setTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_TFACTOR);
+    deviceState::setTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
+    deviceState::setTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+
+	deviceState::setTextureStageState(0, D3DTSS_MAGFILTER, D3DTEXF_LINEAR);
+	deviceState::setTextureStageState(0, D3DTSS_MINFILTER, D3DTEXF_LINEAR);
+	deviceState::setTextureStageState(0, D3DTSS_MIPFILTER, D3DTEXF_LINEAR);
+}
+
 bool createDevice()
 {
 	uint32_t videoFlags = XGetVideoFlags();
@@ -96,7 +185,9 @@ bool createDevice()
 		}
     } 
 
+	int32_t spanId = startupTimeline::begin("Direct3DCreate8", 0);
 	LPDIRECT3D8 d3d = Direct3DCreate8(D3D_SDK_VERSION);
+	startupTimeline::end(spanId);
     if(d3d == NULL)
 	{
 		utils::debugPrint("Failed to create d3d\n");
@@ -120,41 +211,25 @@ bool createDevice()
     params.FullScreen_PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
 
 	LPDIRECT3DDEVICE8 d3dDevice;
-    if (FAILED(d3d->CreateDevice(0, D3DDEVTYPE_HAL, NULL, D3DCREATE_HARDWARE_VERTEXPROCESSING, &params, &d3dDevice)))
+	spanId = startupTimeline::begin("CreateDevice", currentMode);
+	HRESULT result = d3d->CreateDevice(0, D3DDEVTYPE_HAL, NULL, D3DCREATE_HARDWARE_VERTEXPROCESSING, &params, &d3dDevice);
+	startupTimeline::end(spanId);
+    if (FAILED(result))
 	{
 		utils::debugPrint("Failed to create device\n");
         return false;
 	}
 	context::setD3dDevice(d3dDevice);
+	commandList::setBackend(&mD3dCommandBackend);
+	deviceState::invalidate();
 
-	D3DXMATRIX matProjection;
-	D3DXMatrixOrthoOffCenterLH(&matProjection, 0, (float)context::getBufferWidth(), 0, (float)context::getBufferHeight(), 1.0f, 100.0f);
-	context::getD3dDevice()->SetTransform(D3DTS_PROJECTION, &matProjection);
-
-	D3DXMATRIX  matView;
-    D3DXMatrixIdentity(&matView);
-    context::getD3dDevice()->SetTransform( D3DTS_VIEW, &matView);
-
-	D3DXMATRIX matWorld;
-	D3DXMatrixIdentity(&matWorld);
-	context::getD3dDevice()->SetTransform( D3DTS_WORLD, &matWorld);
-
-	context::getD3dDevice()->SetRenderState(D3DRS_LIGHTING, FALSE);
-	context::getD3dDevice()->SetVertexShader(D3DFVF_CUSTOMVERTEX);
-	context::getD3dDevice()->SetRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
-	context::getD3dDevice()->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
-	context::getD3dDevice()->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
-
-	context::getD3dDevice()->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-    context::getD3dDevice()->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_TFACTOR);
-    context::getD3dDevice()->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
-    context::getD3dDevice()->SetTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_TFACTOR);
-    context::getD3dDevice()->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
-    context::getD3dDevice()->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+	if (vertexRing::init() == false || quadIndexBuffer::init() == false)
+	{
+		utils::debugPrint("Failed to create vertex buffers\n");
+		return false;
+	}
 
-	context::getD3dDevice()->SetTextureStageState(0, D3DTSS_MAGFILTER, D3DTEXF_LINEAR);
-	context::getD3dDevice()->SetTextureStageState(0, D3DTSS_MINFILTER, D3DTEXF_LINEAR);
-	context::getD3dDevice()->SetTextureStageState(0, D3DTSS_MIPFILTER, D3DTEXF_LINEAR);
+	setFixedDeviceState();
 
 	context::getD3dDevice()->BeginScene();
 	context::getD3dDevice()->Clear(0L, NULL, D3DCLEAR_TARGET|D3DCLEAR_ZBUFFER|D3DCLEAR_STENCIL, 0xff000000, 1.0f, 0L);
@@ -164,55 +239,599 @@ bool createDevice()
 	return true;
 }
 
-void __cdecl main()
+namespace
 {
-	driveManager::mountDrive("D");
+	const char* mStatusMessage = INSERT_DISK_MESSAGE;
+	uint32_t mProbedEpoch = 0;
+
+	uint32_t mTrayStateTime = 0;
+	char mVerifyMessage[128];
+	bool mVerifyResultShown = false;
+	bool mCaptureRequested = false;
+	int32_t mRenderTaskId = -1;
+	int32_t mFiberTaskId = -1;
+
+	uint64_t mStartupCounter = 0;
+	double mFirstFrameMilliseconds = 0;
+	double mDeviceMilliseconds = 0;
+	double mMountMilliseconds = 0;
+	double mFontLoadMilliseconds = 0;
+	double mPresentMilliseconds = 0;
+	double mManifestMilliseconds = 0;
+	char mStartupGlyphs[STARTUP_GLYPHS_SIZE];
+}
 
-	createDevice();
+void setStatusMessage(const char* message)
+{
+	if (mStatusMessage == message)
+	{
+		return;
+	}
+	mStatusMessage = message;
+	drawing::invalidateFrame();
+}
 
-	drawing::loadFont(&font_sfn[0]);
+// Reject reasons come from the header check and the media classifier, so
+// their text is gathered from them rather than repeated here
+const char* getStartupGlyphs()
+{
+	strcpy(mStartupGlyphs, STARTUP_GLYPHS STARTUP_VERIFY_GLYPHS);
+	for (uint32_t result = xbeHeader::xbeResultOk; result <= xbeHeader::xbeResultBadRegion; result++)
+	{
+		strncat(mStartupGlyphs, xbeHeader::getResultString((xbeHeader::xbeResult)result), STARTUP_GLYPHS_SIZE - strlen(mStartupGlyphs) - 1);
+	}
+	for (uint32_t type = mediaTypeUnreadable; type <= mediaTypeUnclassified; type++)
+	{
+		strncat(mStartupGlyphs, mediaClassifier::getMediaTypeMessage((mediaType)type), STARTUP_GLYPHS_SIZE - strlen(mStartupGlyphs) - 1);
+	}
+	return mStartupGlyphs;
+}
 
-	bitmapFont* fontLarge = drawing::generateBitmapFont("FreeSans", SSFN_STYLE_REGULAR, 32, 32, 0, 512);
-	context::setBitmapFontLarge(fontLarge);
+const char* getInsertDiskMessage()
+{
+	return verifyStation::isEnabled() == true ? VERIFY_INSERT_DISK_MESSAGE : INSERT_DISK_MESSAGE;
+}
 
-	ULONG trayState = 0;
-	HalReadSMCTrayState(&trayState, NULL);
-	if (trayState != SMC_TRAY_STATE_OPEN)
+// The captured frame's command stream is saved for the host commandReplay
+// tool, diffing its output between builds shows draw changes
+void captureFrame()
+{
+	const uint32_t* commands = NULL;
+	uint32_t dwordCount = 0;
+	commandList::getLastFrame(commands, dwordCount);
+	if (dwordCount == 0 || fileSystem::directoryCreate(COMMAND_CAPTURE_DIRECTORY) == false)
 	{
-		HalWriteSMBusByte(0x20, 0x0C, 0); 
+		return;
 	}
 
-    while (TRUE)
-    {
-		context::getD3dDevice()->BeginScene();
+	uint32_t fileHandle = 0;
+	if (fileSystem::fileOpen(COMMAND_CAPTURE_PATH, fileSystem::FileModeWrite, fileHandle) == false)
+	{
+		utils::debugPrint("Failed to open %s\n", COMMAND_CAPTURE_PATH);
+		return;
+	}
+	uint32_t bytesWritten = 0;
+	fileSystem::fileWrite(fileHandle, (char*)commands, dwordCount * sizeof(uint32_t), bytesWritten);
+	fileSystem::fileClose(fileHandle);
+}
 
-		drawing::clearBackground();
+void printLaunchStats()
+{
+	trayMonitor::trayStats trayStats;
+	trayMonitor::getStats(trayStats);
+	utils::debugPrint("Tray monitor: %u polls, %u transitions, %u coalesced\n", trayStats.polls, trayStats.transitions, trayStats.coalescedEvents);
+
+	driveManager::insertionStats insertionStats;
+	driveManager::getInsertionStats(insertionStats);
+	utils::debugPrint("Insertion %u: %u mounts, saved %u mounts, %u dismounts, %u probes\n", insertionStats.epoch, insertionStats.mounts, insertionStats.mountsSaved, insertionStats.dismountsSaved, insertionStats.probesSaved);
+
+	uint32_t framesRendered;
+	uint32_t framesSkipped;
+	drawing::getFrameStats(framesRendered, framesSkipped);
+	utils::debugPrint("Frames: %u rendered, %u skipped\n", framesRendered, framesSkipped);
+
+	// Before batching every quad was its own draw call
+	spriteBatch::batchStats batchStats;
+	spriteBatch::getStats(batchStats);
+	utils::debugPrint("Sprite batch: %u draw calls for %u quads, %u vertices over %u frames, last frame %u draws for %u quads\n", batchStats.drawCalls, batchStats.quads, batchStats.vertices, batchStats.frames, batchStats.lastFrameDrawCalls, batchStats.lastFrameQuads);
+
+	vertexRing::ringStats ringStats;
+	vertexRing::getStats(ringStats);
+	utils::debugPrint("Vertex ring: %u allocations, %u bytes, %u wraps, %u fence waits\n", ringStats.allocations, ringStats.bytes, ringStats.wraps, ringStats.fenceWaits);
+
+	commandList::commandListStats commandListStats;
+	commandList::getStats(commandListStats);
+	utils::debugPrint("Command list: %u commands, %u bytes over %u frames, last frame %u commands in %u bytes, max %u bytes\n", commandListStats.commands, commandListStats.bytes, commandListStats.frames, commandListStats.lastFrameCommands, commandListStats.lastFrameBytes, commandListStats.maxFrameBytes);
+
+	deviceState::stateStats stateStats;
+	deviceState::getStats(stateStats);
+	utils::debugPrint("Device state: %u calls submitted, %u elided over %u frames, last frame %u submitted, %u elided\n", stateStats.submitted, stateStats.elided, stateStats.frames, stateStats.lastFrameSubmitted, stateStats.lastFrameElided);
+
+	discWorker::discWorkerStats discWorkerStats;
+	discWorker::getStats(discWorkerStats);
+	utils::debugPrint("Disc worker: %u jobs, %u stalls, max stall %ums\n", discWorkerStats.jobs, discWorkerStats.stalls, discWorkerStats.maxStallMilliseconds);
+
+	thermalMonitor::thermalSample thermalSample;
+	thermalMonitor::getLastSample(thermalSample);
+	utils::debugPrint("Thermal: %s, cpu %uC, board %uC\n", thermalMonitor::getLevelString(thermalMonitor::getLevel()), thermalSample.cpuTemperature, thermalSample.boardTemperature);
+
+	fiberScheduler::fiberStats fiberStats;
+	fiberScheduler::getStats(fiberStats);
+	utils::debugPrint("Fibers: %u spawned, %u completed, %u switches, %u frames over budget\n", fiberStats.spawned, fiberStats.completed, fiberStats.switches, fiberStats.overBudgetFrames);
+
+	scheduler::printStats();
+	sectionLoader::printStats();
+	launchCache::printStats();
+}
 
-		drawing::drawBitmapStringAligned(context::getBitmapFontLarge(), "Please Insert Disk To Continue...", 0xffffffff, horizAlignmentCenter, 40, 230, 640);
+void launchDisc(const char* launchPath, uint32_t titleId)
+{
+	if (LaunchDataPage == NULL)
+	{
+		LaunchDataPage = (LAUNCH_DATA_PAGE*)MmAllocateContiguousMemory(0x1000);
+		MmPersistContiguousMemory(LaunchDataPage, 0x1000, TRUE);
+		memset(LaunchDataPage, 0, 0x1000);
+		LaunchDataPage->Header.dwLaunchDataType = LDT_FROM_DASHBOARD;
+		LaunchDataPage->Header.dwTitleId = 0;
+	}	
+
+	LaunchDataPage->Header.dwTitleId = titleId;
+	LaunchDataPage->Header.dwFlags = 0;
+	strncpy(&LaunchDataPage->Header.szLaunchPath[0], launchPath, sizeof(LaunchDataPage->Header.szLaunchPath) - 1);
+	launchTimer::mark(launchPhaseLaunchDataFilled);
+	traceRing::write(traceEventLaunch, titleId);
+
+	trayMonitor::stop();
+
+	// Nothing timed runs between here and HalReturnToFirmware, the samples
+	// have to be committed before it so the E: writes below follow the
+	// last mark and stay out of every phase
+	launchTimer::mark(launchPhaseFirmwareReturn);
+	launchTimer::commit();
+	launchTimer::save();
+	launchCache::save();
+	sessionRecorder::save();
+	printLaunchStats();
+	launchTimer::print();
+
+	// A replayed session ends where the recorded one rebooted
+	if (sessionRecorder::isReplaying() == true)
+	{
+		utils::debugPrint("Replay reached launch of %s\n", launchPath);
+		setStatusMessage(REPLAY_COMPLETE_MESSAGE);
+		return;
+	}
+
+	HalReturnToFirmware(2);
+}
+
+void trayCallbackHandler(trayOperation operation, trayResult result, void* userData)
+{
+	utils::debugPrint("Tray %s: %s\n", trayController::getOperationString(operation), trayController::getResultString(result));
+}
+
+void recoverStalledDrive()
+{
+	traceRing::write(traceEventDriveStalled, driveManager::getInsertionEpoch());
+	sessionRecorder::saveInBackground();
+
+	// The abandoned job's thread may be blocked inside D:, dismounting is
+	// what fails its I/O and lets it return
+	driveManager::unmountDrive("D");
+	trayController::cancel();
+	trayController::eject(TRAY_EJECT_TIMEOUT, trayCallbackHandler, NULL);
+	mProbedEpoch = driveManager::getInsertionEpoch();
+	setStatusMessage(DRIVE_STALLED_MESSAGE);
+}
+
+// A ejects or closes the tray, B ejects, Back cancels a pending tray
+// operation or a running verification.
+void inputTask(void* userData)
+{
+	uint32_t* trayState = (uint32_t*)userData;
+
+	inputManager::update();
+
+	inputManager::inputEvent event;
+	while (inputManager::pollEvent(event) == true)
+	{
+		if (event.pressed == false)
+		{
+			continue;
+		}
+
+		if (event.button == inputButtonA)
+		{
+			bool trayOpen = *trayState == SMC_TRAY_STATE_OPEN || *trayState == SMC_TRAY_STATE_OPENING;
+			if (trayOpen == true)
+			{
+				trayController::close(TRAY_CLOSE_TIMEOUT, trayCallbackHandler, NULL);
+			}
+			else
+			{
+				trayController::eject(TRAY_EJECT_TIMEOUT, trayCallbackHandler, NULL);
+			}
+		}
+		else if (event.button == inputButtonB)
+		{
+			trayController::eject(TRAY_EJECT_TIMEOUT, trayCallbackHandler, NULL);
+		}
+		else if (event.button == inputButtonBack)
+		{
+			trayController::cancel();
+			if (verifyStation::getState() == verifyStateRunning)
+			{
+				verifyStation::cancel();
+			}
+		}
+	}
+}
+
+void trayTask(void* userData)
+{
+	uint32_t* trayState = (uint32_t*)userData;
+	while (trayMonitor::pollEvent(*trayState) == true)
+	{
+		utils::debugPrint("Tray state changed to 0x%02x\n", *trayState);
+		driveManager::trayStateChanged(*trayState);
+		traceRing::write(traceEventTrayState, *trayState);
+		mTrayStateTime = GetTickCount();
 
-		HalReadSMCTrayState(&trayState, NULL);
-		if (trayState == SMC_TRAY_STATE_MEDIA_DETECT)
+		if (*trayState == SMC_TRAY_STATE_CLOSING || *trayState == SMC_TRAY_STATE_CLOSED)
+		{
+			launchTimer::mark(launchPhaseTrayClosed);
+			mVerifyResultShown = false;
+		}
+		else if (*trayState == SMC_TRAY_STATE_MEDIA_DETECT)
 		{
-			driveManager::mountDrive("D");
-			bool exists = false;
-			if (fileSystem::fileExists("D:\\default.xbe", exists) == true && exists == true)
+			launchTimer::mark(launchPhaseMediaDetected);
+		}
+		else if (*trayState == SMC_TRAY_STATE_OPENING || *trayState == SMC_TRAY_STATE_OPEN)
+		{
+			launchTimer::reset();
+			if (verifyStation::getState() == verifyStateRunning)
+			{
+				verifyStation::cancel();
+			}
+			if (mVerifyResultShown == false)
 			{
-				if (LaunchDataPage == NULL)
-				{
-					LaunchDataPage = (LAUNCH_DATA_PAGE*)MmAllocateContiguousMemory(0x1000);
-					MmPersistContiguousMemory(LaunchDataPage, 0x1000, TRUE);
-					memset(LaunchDataPage, 0, 0x1000);
-					LaunchDataPage->Header.dwLaunchDataType = LDT_FROM_DASHBOARD;
-					LaunchDataPage->Header.dwTitleId = 0;
-				}	
-
-				LaunchDataPage->Header.dwFlags = 0;
-				strcpy(&LaunchDataPage->Header.szLaunchPath[0], "D:\\;Default.xbe");
-				HalReturnToFirmware(2);
+				setStatusMessage(getInsertDiskMessage());
 			}
 		}
+	}
+	trayController::update(*trayState, GetTickCount());
 
-		context::getD3dDevice()->EndScene();
-		context::getD3dDevice()->Present(NULL, NULL, NULL, NULL);
-    }
+	// A drive that never leaves closing or activity is reset by ejecting
+	uint32_t trayStateDuration = GetTickCount() - mTrayStateTime;
+	if ((*trayState == SMC_TRAY_STATE_CLOSING || *trayState == SMC_TRAY_STATE_ACTIVITY) && trayStateDuration >= TRAY_STALL_TIMEOUT && trayController::isBusy() == false)
+	{
+		utils::debugPrint("Tray stalled in state 0x%02x for %ums\n", *trayState, trayStateDuration);
+		mTrayStateTime = GetTickCount();
+		recoverStalledDrive();
+	}
+}
+
+void probeDiscJob(void* userData)
+{
+	discProbe::probeResult* probe = (discProbe::probeResult*)userData;
+	discProbe::run(probe);
+
+	sessionRecorder::replayStats replayStats;
+	sessionRecorder::getReplayStats(replayStats);
+	if (replayStats.exhausted == true && probe->launch == false)
+	{
+		probe->rejectReason = REPLAY_EXHAUSTED_MESSAGE;
+	}
+}
+
+void completeDiscProbe(uint32_t trayState)
+{
+	discProbe::probeResult* probe = NULL;
+	discJobState state = discWorker::poll((void**)&probe);
+	if (state == discJobStateStalled)
+	{
+		recoverStalledDrive();
+		return;
+	}
+	if (state != discJobStateCompleted)
+	{
+		return;
+	}
+
+	// Results for a disc that has since been ejected are dropped
+	if (probe->epoch == driveManager::getInsertionEpoch() && trayState == SMC_TRAY_STATE_MEDIA_DETECT)
+	{
+		launchTimer::mark(launchPhaseDriveMounted, probe->mountedAt);
+		launchTimer::mark(launchPhaseXbeProbed, probe->probedAt);
+		traceRing::write(traceEventDriveMounted, probe->epoch);
+		traceRing::write(traceEventMediaClassified, probe->media);
+		traceRing::write(traceEventXbeProbed, probe->titleId);
+		if (probe->verify == true)
+		{
+			verifyStation::start();
+		}
+		else if (probe->launch == true)
+		{
+			launchDisc(probe->launchPath, probe->titleId);
+		}
+		else
+		{
+			utils::debugPrint("Rejected disc: %s\n", probe->rejectReason);
+			traceRing::write(traceEventDiscRejected, probe->epoch);
+			setStatusMessage(probe->rejectReason);
+		}
+	}
+	free(probe);
+}
+
+void driveTask(void* userData)
+{
+	uint32_t* trayState = (uint32_t*)userData;
+	if (discWorker::isBusy() == true)
+	{
+		completeDiscProbe(*trayState);
+		return;
+	}
+
+	uint32_t epoch = driveManager::getInsertionEpoch();
+	if (*trayState != SMC_TRAY_STATE_MEDIA_DETECT || trayController::getOperation() == trayOperationEject)
+	{
+		return;
+	}
+	if (epoch == mProbedEpoch)
+	{
+		driveManager::probeSkipped("D");
+		return;
+	}
+
+	// A new probe waits for a stalled one's thread to leave the drive
+	if (discWorker::hasAbandonedJob() == true)
+	{
+		return;
+	}
+
+	// Disc I/O runs on the worker so a hung drive cannot freeze rendering
+	discProbe::probeResult* probe = (discProbe::probeResult*)malloc(sizeof(discProbe::probeResult));
+	memset(probe, 0, sizeof(discProbe::probeResult));
+	probe->epoch = epoch;
+	probe->verify = verifyStation::isEnabled();
+	if (discWorker::start(probeDiscJob, probe, DISC_JOB_DEADLINE) == false)
+	{
+		free(probe);
+		return;
+	}
+	mProbedEpoch = epoch;
 }
+
+void verifyTask(void* userData)
+{
+	verifyState state = verifyStation::getState();
+	if (state == verifyStateIdle)
+	{
+		return;
+	}
+
+	verifyStation::verifyProgress progress;
+	verifyStation::getProgress(progress);
+	double megabytesPerSecond = progress.elapsedMilliseconds == 0 ? 0 : (progress.kilobytesDone / 1024.0) / (progress.elapsedMilliseconds / 1000.0);
+
+	if (state == verifyStateRunning)
+	{
+		uint32_t remainingSeconds = megabytesPerSecond <= 0 ? 0 : (uint32_t)(((progress.totalKilobytes - progress.kilobytesDone) / 1024.0) / megabytesPerSecond);
+		sprintf(mVerifyMessage, "Verifying %u/%u files, %.1f MB/s, ETA %u:%02u", progress.filesDone, progress.fileCount, megabytesPerSecond, remainingSeconds / 60, remainingSeconds % 60);
+		setStatusMessage(mVerifyMessage);
+		drawing::invalidateFrame();
+		return;
+	}
+
+	verifyStation::reset();
+	if (state == verifyStateCancelled)
+	{
+		return;
+	}
+
+	if (progress.mismatched == 0 && progress.missing == 0 && progress.unlisted == 0)
+	{
+		sprintf(mVerifyMessage, "Verified %u files OK at %.1f MB/s", progress.matched, megabytesPerSecond);
+	}
+	else
+	{
+		sprintf(mVerifyMessage, "Verify FAILED: %u bad, %u missing, %u extra", progress.mismatched, progress.missing, progress.unlisted);
+	}
+	setStatusMessage(mVerifyMessage);
+	drawing::invalidateFrame();
+	mVerifyResultShown = true;
+	trayController::eject(TRAY_EJECT_TIMEOUT, trayCallbackHandler, NULL);
+}
+
+// Hotter consoles render, poll the drive and poll the tray less often
+void thermalTask(void* userData)
+{
+	if (thermalMonitor::sample() == false)
+	{
+		return;
+	}
+
+	// Input and tray keep their once per vblank sampling, only drawing
+	// and the background fibers give up frames while the box runs hot
+	uint32_t scale = thermalMonitor::getThrottleScale();
+	scheduler::setTaskInterval(mRenderTaskId, RENDER_TASK_INTERVAL * scale);
+	scheduler::setTaskInterval(mFiberTaskId, FIBER_TASK_INTERVAL * scale);
+	trayMonitor::setPollScale(scale);
+}
+
+void fiberTask(void* userData)
+{
+	fiberScheduler::run(FIBER_FRAME_BUDGET);
+}
+
+// Generated on a fiber so the atlas is built across frames rather than
+// holding up the first one, it replaces the startup glyph set when done.
+void generateFontFiber(void* userData)
+{
+	uint64_t fontStart = utils::getPerformanceCounter();
+	int32_t spanId = startupTimeline::begin("Full font", 512);
+	bitmapFont* fontLarge = drawing::generateBitmapFont("FreeSans", SSFN_STYLE_REGULAR, 32, 32, 0, 512);
+	startupTimeline::end(spanId);
+	double fontMilliseconds = utils::getElapsedMilliseconds(mStartupCounter, utils::getPerformanceCounter());
+
+	bitmapFont* startupFont = context::getBitmapFontLarge();
+	context::setBitmapFontLarge(fontLarge);
+	drawing::invalidateFrame();
+	if (startupFont != NULL)
+	{
+		deviceState::forgetTexture(startupFont->image->texture);
+		delete(startupFont);
+	}
+
+	// Run in sequence, as startup used to, the first frame would wait on
+	// every step. The full font is timed across the frames it shared.
+	double fullFontMilliseconds = utils::getElapsedMilliseconds(fontStart, utils::getPerformanceCounter());
+	double sequentialMilliseconds = mDeviceMilliseconds + mMountMilliseconds + mFontLoadMilliseconds + fullFontMilliseconds + mManifestMilliseconds + mPresentMilliseconds;
+	utils::debugPrint("Startup: first frame at %.2fms, full font at %.2fms\n", mFirstFrameMilliseconds, fontMilliseconds);
+	utils::debugPrint("Startup in sequence: %.2fms from device %.2fms, D: mount and session %.2fms, font load %.2fms, full font %.2fms, manifest %.2fms, present %.2fms\n", sequentialMilliseconds, mDeviceMilliseconds, mMountMilliseconds, mFontLoadMilliseconds, fullFontMilliseconds, mManifestMilliseconds, mPresentMilliseconds);
+	startupTimeline::complete();
+}
+
+// The session files on E: load here too, they have to be in place before
+// the tray monitor starts but not before the first frame
+DWORD WINAPI mountThread(LPVOID param)
+{
+	uint64_t mountStart = utils::getPerformanceCounter();
+	int32_t spanId = startupTimeline::begin("mountDrive", 'D');
+	driveManager::mountDrive("D");
+	startupTimeline::end(spanId);
+
+	spanId = startupTimeline::begin("Session recorder", 0);
+	sessionRecorder::init();
+	startupTimeline::end(spanId);
+	mMountMilliseconds = utils::getElapsedMilliseconds(mountStart, utils::getPerformanceCounter());
+	return 0;
+}
+
+void renderTask(void* userData)
+{
+	// A captured frame records all of its state rather than relying on what
+	// earlier frames left on the device, and carries its vertices
+	if (mCaptureRequested == true)
+	{
+		deviceState::invalidate();
+		setFixedDeviceState();
+		commandList::setCapturing(true);
+	}
+
+	if (drawing::beginFrame() == false)
+	{
+		return;
+	}
+	drawing::clearBackground();
+	if (context::getBitmapFontLarge() != NULL)
+	{
+		drawing::drawBitmapStringAligned(context::getBitmapFontLarge(), mStatusMessage, 0xffffffff, horizAlignmentCenter, 40, 230, 640);
+	}
+	drawing::endFrame();
+
+	if (mCaptureRequested == true)
+	{
+		mCaptureRequested = false;
+		commandList::setCapturing(false);
+		captureFrame();
+	}
+}
+
+void __cdecl main()
+{
+	mStartupCounter = utils::getPerformanceCounter();
+	startupTimeline::init();
+	traceRing::init();
+
+	// D: mounts on its own thread while the device comes up, so the drive
+	// spinning up no longer delays the first frame
+	HANDLE mountHandle = CreateThread(NULL, 0, mountThread, NULL, 0, NULL);
+	if (mountHandle == NULL)
+	{
+		mountThread(NULL);
+	}
+
+	// Nothing can be shown or drawn without the device, so reboot to the
+	// dashboard rather than running blind. A quick reboot could relaunch
+	// this xbe from stale launch data.
+	if (createDevice() == false)
+	{
+		utils::debugPrint("Unable to start without a device, returning to dashboard\n");
+		if (mountHandle != NULL)
+		{
+			WaitForSingleObject(mountHandle, INFINITE);
+			CloseHandle(mountHandle);
+		}
+		HalReturnToFirmware(RETURN_FIRMWARE_REBOOT);
+		return;
+	}
+	mDeviceMilliseconds = utils::getElapsedMilliseconds(mStartupCounter, utils::getPerformanceCounter());
+
+	uint64_t fontLoadStart = utils::getPerformanceCounter();
+	drawing::loadFont(&font_sfn[0]);
+	mFontLoadMilliseconds = utils::getElapsedMilliseconds(fontLoadStart, utils::getPerformanceCounter());
+
+	int32_t spanId = startupTimeline::begin("Startup font", STARTUP_FONT_TEXTURE_SIZE);
+	context::setBitmapFontLarge(drawing::generateBitmapFont("FreeSans", SSFN_STYLE_REGULAR, 32, 32, 0, STARTUP_FONT_TEXTURE_SIZE, getStartupGlyphs()));
+	startupTimeline::end(spanId);
+
+	spanId = startupTimeline::begin("First Present", 0);
+	uint64_t presentStart = utils::getPerformanceCounter();
+	drawing::invalidateFrame();
+	renderTask(NULL);
+	startupTimeline::end(spanId);
+	mPresentMilliseconds = utils::getElapsedMilliseconds(presentStart, utils::getPerformanceCounter());
+	mFirstFrameMilliseconds = utils::getElapsedMilliseconds(mStartupCounter, utils::getPerformanceCounter());
+
+	fiberScheduler::init();
+	fiberScheduler::spawn("font", generateFontFiber, NULL, FIBER_DEFAULT_STACK_SIZE);
+
+	// The tray is ejected below, the mount it races with has to finish first
+	if (mountHandle != NULL)
+	{
+		WaitForSingleObject(mountHandle, INFINITE);
+		CloseHandle(mountHandle);
+	}
+
+	// E: is free of the mount thread now, the manifest only changes the
+	// status shown so it does not hold up the first frame
+	uint64_t manifestStart = utils::getPerformanceCounter();
+	spanId = startupTimeline::begin("Verify manifest", 0);
+	if (verifyStation::loadManifest() == true)
+	{
+		setStatusMessage(getInsertDiskMessage());
+	}
+	startupTimeline::end(spanId);
+	mManifestMilliseconds = utils::getElapsedMilliseconds(manifestStart, utils::getPerformanceCounter());
+
+	// Capturing a frame is a debugging aid, only done on request and never
+	// on the launch path
+	bool captureFlag = false;
+	if (fileSystem::fileExists(COMMAND_CAPTURE_FLAG_PATH, captureFlag) == true && captureFlag == true)
+	{
+		utils::debugPrint("Capturing a frame to %s\n", COMMAND_CAPTURE_PATH);
+		mCaptureRequested = true;
+		drawing::invalidateFrame();
+	}
+
+	inputManager::init();
+	trayMonitor::start();
+
+	uint32_t trayState = trayMonitor::getTrayState();
+	trayController::eject(TRAY_EJECT_TIMEOUT, trayCallbackHandler, NULL);
+
+	scheduler::addTask("input", inputTask, &trayState, INPUT_TASK_INTERVAL);
+	scheduler::addTask("tray", trayTask, &trayState, TRAY_TASK_INTERVAL);
+	scheduler::addTask("drive", driveTask, &trayState, DRIVE_TASK_INTERVAL);
+	scheduler::addTask("verify", verifyTask, NULL, VERIFY_TASK_INTERVAL);
+	scheduler::addTask("thermal", thermalTask, NULL, THERMAL_TASK_INTERVAL);
+	mFiberTaskId = scheduler::addTask("fibers", fiberTask, NULL, FIBER_TASK_INTERVAL);
+	mRenderTaskId = scheduler::addTask("render", renderTask, NULL, RENDER_TASK_INTERVAL);
+
+    while (TRUE)
+    {
+		scheduler::runFrame();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "mediaClassifier.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define CDROM_DEVICE_PATH "\\Device\\CdRom0"
+#define SECTOR_SIZE 2048
+
+#define XDVDFS_DESCRIPTOR_SECTOR 32
+#define XDVDFS_MAGIC "MICROSOFT*XBOX*MEDIA"
+#define XDVDFS_MAGIC_LENGTH 20
+#define XDVDFS_MAGIC_TAIL_OFFSET 0x7EC
+
+#define VOLUME_DESCRIPTOR_SECTOR 16
+#define VOLUME_DESCRIPTOR_COUNT 4
+#define ISO9660_ROOT_RECORD_OFFSET 156
+#define ISO9660_MAX_ROOT_SECTORS 8
+
+#define TOC_CONTROL_DATA_TRACK 0x04
+
+namespace
+{
+	typedef struct tocTrack
+	{
+		uint8_t reserved;
+		uint8_t controlAdr;
+		uint8_t trackNumber;
+		uint8_t reserved1;
+		uint8_t address[4];
+	} tocTrack;
+
+	typedef struct cdromToc
+	{
+		uint8_t length[2];
+		uint8_t firstTrack;
+		uint8_t lastTrack;
+		tocTrack tracks[100];
+	} cdromToc;
+
+	uint32_t readUInt32(const uint8_t* buffer, uint32_t offset)
+	{
+		return (uint32_t)buffer[offset] | ((uint32_t)buffer[offset + 1] << 8) | ((uint32_t)buffer[offset + 2] << 16) | ((uint32_t)buffer[offset + 3] << 24);
+	}
+
+	HANDLE openDevice()
+	{
+		char devicePath[] = CDROM_DEVICE_PATH;
+		STRING sDevicePath;
+		sDevicePath.Length = (USHORT)strlen(devicePath);
+		sDevicePath.MaximumLength = (USHORT)(sDevicePath.Length + 1);
+		sDevicePath.Buffer = devicePath;
+		OBJECT_ATTRIBUTES attributes;
+		attributes.RootDirectory = NULL;
+		attributes.ObjectName = &sDevicePath;
+		attributes.Attributes = OBJ_CASE_INSENSITIVE;
+		IO_STATUS_BLOCK statusBlock;
+		HANDLE device;
+		if (NtOpenFile(&device, GENERIC_READ | SYNCHRONIZE, &attributes, &statusBlock, FILE_SHARE_READ, FILE_SYNCHRONOUS_IO_NONALERT) < 0)
+		{
+			return INVALID_HANDLE_VALUE;
+		}
+		return device;
+	}
+
+	bool readSector(HANDLE device, uint32_t sector, uint8_t* buffer)
+	{
+		LONG offsetHigh = (LONG)(sector >> 21);
+		if (SetFilePointer(device, (LONG)(sector << 11), &offsetHigh, FILE_BEGIN) == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR)
+		{
+			return false;
+		}
+		DWORD bytesRead = 0;
+		return ReadFile(device, buffer, SECTOR_SIZE, &bytesRead, NULL) == TRUE && bytesRead == SECTOR_SIZE;
+	}
+
+	bool isXdvdfsDescriptor(const uint8_t* buffer)
+	{
+		return memcmp(buffer, XDVDFS_MAGIC, XDVDFS_MAGIC_LENGTH) == 0 && memcmp(buffer + XDVDFS_MAGIC_TAIL_OFFSET, XDVDFS_MAGIC, XDVDFS_MAGIC_LENGTH) == 0;
+	}
+
+	bool isIso9660PrimaryDescriptor(const uint8_t* buffer)
+	{
+		return buffer[0] == 1 && memcmp(buffer + 1, "CD001", 5) == 0;
+	}
+
+	// DVD-Video discs are UDF bridge discs, so VIDEO_TS is also listed in
+	// the ISO9660 root directory which is far simpler to walk than UDF.
+	bool hasVideoTsDirectory(HANDLE device, const uint8_t* primaryDescriptor, uint8_t* buffer)
+	{
+		const uint8_t* rootRecord = primaryDescriptor + ISO9660_ROOT_RECORD_OFFSET;
+		uint32_t rootSector = readUInt32(rootRecord, 2);
+		uint32_t rootSectors = min((readUInt32(rootRecord, 10) + SECTOR_SIZE - 1) / SECTOR_SIZE, ISO9660_MAX_ROOT_SECTORS);
+
+		for (uint32_t i = 0; i < rootSectors; i++)
+		{
+			if (readSector(device, rootSector + i, buffer) == false)
+			{
+				return false;
+			}
+
+			uint32_t offset = 0;
+			while (offset < SECTOR_SIZE - 33)
+			{
+				uint32_t recordLength = buffer[offset];
+				if (recordLength < 34 || offset + recordLength > SECTOR_SIZE)
+				{
+					break;
+				}
+				uint32_t nameLength = buffer[offset + 32];
+				if (nameLength == 8 && 33 + nameLength <= recordLength && memcmp(buffer + offset + 33, "VIDEO_TS", 8) == 0)
+				{
+					return true;
+				}
+				offset += recordLength;
+			}
+		}
+		return false;
+	}
+
+	bool hasAudioTracks(HANDLE device)
+	{
+		cdromToc toc;
+		memset(&toc, 0, sizeof(toc));
+		DWORD bytesReturned = 0;
+		if (DeviceIoControl(device, IOCTL_CDROM_READ_TOC, NULL, 0, &toc, sizeof(toc), &bytesReturned, NULL) == FALSE)
+		{
+			return false;
+		}
+
+		uint32_t trackCount = toc.lastTrack >= toc.firstTrack ? min(toc.lastTrack - toc.firstTrack + 1, 99) : 0;
+		for (uint32_t i = 0; i < trackCount; i++)
+		{
+			if ((toc.tracks[i].controlAdr & TOC_CONTROL_DATA_TRACK) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	mediaType classifyDevice(HANDLE device, uint8_t* buffer, uint8_t* directoryBuffer)
+	{
+		if (readSector(device, XDVDFS_DESCRIPTOR_SECTOR, buffer) == true && isXdvdfsDescriptor(buffer) == true)
+		{
+			return mediaTypeXboxGame;
+		}
+
+		// UDF only discs have no ISO9660 descriptor and end up as data discs
+		bool readable = false;
+		for (uint32_t i = 0; i < VOLUME_DESCRIPTOR_COUNT; i++)
+		{
+			if (readSector(device, VOLUME_DESCRIPTOR_SECTOR + i, buffer) == false)
+			{
+				break;
+			}
+			readable = true;
+			if (isIso9660PrimaryDescriptor(buffer) == true)
+			{
+				return hasVideoTsDirectory(device, buffer, directoryBuffer) == true ? mediaTypeDvdVideo : mediaTypeDataDisc;
+			}
+		}
+
+		// Audio sectors cannot be read as 2048 byte data sectors, only the TOC
+		// tells an audio CD apart from a blank or unreadable disc.
+		if (readable == false)
+		{
+			return hasAudioTracks(device) == true ? mediaTypeAudioCd : mediaTypeUnreadable;
+		}
+		return mediaTypeDataDisc;
+	}
+}
+
+mediaType mediaClassifier::classify()
+{
+	HANDLE device = openDevice();
+	if (device == INVALID_HANDLE_VALUE)
+	{
+		// Says nothing about the disc, so the probe's own reason stands
+		utils::debugPrint("Unable to open %s\n", CDROM_DEVICE_PATH);
+		return mediaTypeUnclassified;
+	}
+
+	uint8_t* buffer = (uint8_t*)malloc(SECTOR_SIZE * 2);
+	mediaType type = classifyDevice(device, buffer, buffer + SECTOR_SIZE);
+	free(buffer);
+	CloseHandle(device);
+
+	utils::debugPrint("Media classified as %s\n", getMediaTypeString(type));
+	return type;
+}
+
+const char* mediaClassifier::getMediaTypeString(mediaType type)
+{
+	if (type == mediaTypeXboxGame)
+	{
+		return "Xbox game disc";
+	}
+	if (type == mediaTypeDvdVideo)
+	{
+		return "DVD-Video";
+	}
+	if (type == mediaTypeAudioCd)
+	{
+		return "Audio CD";
+	}
+	if (type == mediaTypeDataDisc)
+	{
+		return "Data disc";
+	}
+	if (type == mediaTypeUnclassified)
+	{
+		return "Unclassified";
+	}
+	return "Unreadable";
+}
+
+const char* mediaClassifier::getMediaTypeMessage(mediaType type)
+{
+	if (type == mediaTypeDvdVideo)
+	{
+		return "DVD-Video disc inserted, please insert a game";
+	}
+	if (type == mediaTypeAudioCd)
+	{
+		return "Audio CD inserted, please insert a game";
+	}
+	if (type == mediaTypeUnreadable)
+	{
+		return "Disc is blank or unreadable";
+	}
+	return "";
+}
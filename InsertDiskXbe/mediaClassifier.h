@@ -0,0 +1,26 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+typedef enum mediaType
+{
+	mediaTypeUnreadable = 0,
+	mediaTypeXboxGame = 1,
+	mediaTypeDvdVideo = 2,
+	mediaTypeAudioCd = 3,
+	mediaTypeDataDisc = 4,
+	mediaTypeUnclassified = 5
+} mediaType;
+
+class mediaClassifier
+{
+public:
+
+	// Reads the volume descriptors straight from the drive, a handful of
+	// sectors at most, without touching the D: file system. Only used to
+	// explain a rejection, a pressed disc that is not yet authenticated
+	// exposes its DVD-Video partition and classifies as DVD-Video.
+	static mediaType classify();
+	static const char* getMediaTypeString(mediaType type);
+	static const char* getMediaTypeMessage(mediaType type);
+};
@@ -3,32 +3,24 @@
 #include "math.h"
 #include "utils.h"
 
+#define D3DFVF_COLORVERTEX (D3DFVF_XYZ|D3DFVF_DIFFUSE|D3DFVF_TEX1)
+#define QUAD_VERTEX_COUNT 4
+#define QUAD_INDEX_COUNT 6
+
 class meshUtility
 {
 public:
 
-	typedef struct vertex
+	// Matches D3DFVF_COLORVERTEX, the diffuse color carries the tint
+	typedef struct colorVertex
 	{
 		math::vec3F position;
+		uint32_t diffuse;
 		math::vec2F texcoord;
+	} colorVertex;
 
-		vertex()
-		{
-			position = math::vec3F();
-			texcoord = math::vec2F();
-		}
-
-		vertex(const float& positionX, const float& positionY, const float& positionZ, 
-			   const float& texcoordX, const float& texcoordY) 
-		{
-			position = math::vec3F(positionX, positionY, positionZ);
-			texcoord = math::vec2F(texcoordX, texcoordY);
-		}
-
-		vertex(const math::vec3F& position, const math::vec2F& texcoord) : position(position), texcoord(texcoord) {}
-
-	} vertex;	
-
-	static utils::dataContainer* createQuadXY(const math::vec3F& position, const math::sizeF& size, const math::rectF& uvRect);
-	static utils::dataContainer* createNinePatchXY(const math::vec3F& position, const math::sizeF& size, const math::rectF& uvRect);
+	// Quads are 4 unique vertices drawn as an indexed triangle list with
+	// the writeQuadIndices pattern (see quadIndexBuffer).
+	static void fillQuadXY(colorVertex* vertices, const math::vec3F& position, const math::sizeF& size, const math::rectF& uvRect, uint32_t color);
+	static void writeQuadIndices(uint16_t* indices, uint32_t quadCount);
 };
@@ -0,0 +1,42 @@
+#include "quadIndexBuffer.h"
+#include "meshUtility.h"
+#include "context.h"
+#include "deviceState.h"
+#include "utils.h"
+
+#define QUAD_INDEX_TOTAL (QUAD_INDEX_MAX_QUADS * QUAD_INDEX_COUNT)
+
+namespace
+{
+	D3DIndexBuffer* mIndexBuffer = NULL;
+}
+
+bool quadIndexBuffer::init()
+{
+	if (mIndexBuffer != NULL)
+	{
+		return true;
+	}
+
+	if (FAILED(context::getD3dDevice()->CreateIndexBuffer(QUAD_INDEX_TOTAL * sizeof(uint16_t), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &mIndexBuffer)))
+	{
+		utils::debugPrint("Failed to create quad index buffer\n");
+		return false;
+	}
+
+	BYTE* data = NULL;
+	if (FAILED(mIndexBuffer->Lock(0, 0, &data, 0)))
+	{
+		mIndexBuffer->Release();
+		mIndexBuffer = NULL;
+		return false;
+	}
+	meshUtility::writeQuadIndices((uint16_t*)data, QUAD_INDEX_MAX_QUADS);
+	mIndexBuffer->Unlock();
+	return true;
+}
+
+void quadIndexBuffer::bind(uint32_t baseVertex)
+{
+	deviceState::setIndices(mIndexBuffer, baseVertex);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define QUAD_INDEX_MAX_QUADS 1024
+
+class quadIndexBuffer
+{
+public:
+
+	// One static 16 bit index buffer shared by every indexed UI draw, the
+	// quad pattern for up to QUAD_INDEX_MAX_QUADS quads. bind sets
+	// baseVertex so indices are relative to the first vertex of the draw,
+	// such as a vertexRing start vertex, and every draw starts at index 0.
+	static bool init();
+	static void bind(uint32_t baseVertex);
+};
@@ -0,0 +1,125 @@
+#include "scheduler.h"
+#include "context.h"
+#include "utils.h"
+
+#define SCHEDULER_MAX_TASKS 16
+
+namespace
+{
+	typedef struct task
+	{
+		const char* name;
+		taskCallback callback;
+		void* userData;
+		uint32_t interval;
+		uint32_t nextFrame;
+		uint32_t runs;
+		double totalMilliseconds;
+		double maxMilliseconds;
+	} task;
+
+	task mTasks[SCHEDULER_MAX_TASKS];
+	uint32_t mTaskCount = 0;
+	uint32_t mFrameCount = 0;
+	double mWaitMilliseconds = 0;
+}
+
+int32_t scheduler::addTask(const char* name, taskCallback callback, void* userData, uint32_t interval)
+{
+	if (mTaskCount == SCHEDULER_MAX_TASKS)
+	{
+		return -1;
+	}
+
+	task* newTask = &mTasks[mTaskCount];
+	memset(newTask, 0, sizeof(task));
+	newTask->name = name;
+	newTask->callback = callback;
+	newTask->userData = userData;
+	newTask->interval = interval == 0 ? 1 : interval;
+	newTask->nextFrame = mFrameCount;
+	mTaskCount++;
+	return mTaskCount - 1;
+}
+
+void scheduler::setTaskInterval(int32_t taskId, uint32_t interval)
+{
+	if (taskId < 0 || (uint32_t)taskId >= mTaskCount)
+	{
+		return;
+	}
+	task* currentTask = &mTasks[taskId];
+	currentTask->interval = interval == 0 ? 1 : interval;
+	currentTask->nextFrame = min(currentTask->nextFrame, mFrameCount + currentTask->interval);
+}
+
+void scheduler::runFrame()
+{
+	// Sleeps the thread until the next vertical blank so the tasks below
+	// are paced by the display rather than spinning the CPU.
+	uint64_t waitStart = utils::getPerformanceCounter();
+	context::getD3dDevice()->BlockUntilVerticalBlank();
+	mWaitMilliseconds += utils::getElapsedMilliseconds(waitStart, utils::getPerformanceCounter());
+
+	for (uint32_t i = 0; i < mTaskCount; i++)
+	{
+		task* currentTask = &mTasks[i];
+		if ((int32_t)(mFrameCount - currentTask->nextFrame) < 0)
+		{
+			continue;
+		}
+
+		uint64_t taskStart = utils::getPerformanceCounter();
+		currentTask->callback(currentTask->userData);
+		double elapsed = utils::getElapsedMilliseconds(taskStart, utils::getPerformanceCounter());
+
+		currentTask->runs++;
+		currentTask->totalMilliseconds += elapsed;
+		currentTask->maxMilliseconds = max(currentTask->maxMilliseconds, elapsed);
+		currentTask->nextFrame = mFrameCount + currentTask->interval;
+	}
+
+	mFrameCount++;
+}
+
+uint32_t scheduler::getFrameCount()
+{
+	return mFrameCount;
+}
+
+uint32_t scheduler::getTaskCount()
+{
+	return mTaskCount;
+}
+
+bool scheduler::getTaskStats(int32_t taskId, taskStats& stats)
+{
+	if (taskId < 0 || (uint32_t)taskId >= mTaskCount)
+	{
+		return false;
+	}
+	task* currentTask = &mTasks[taskId];
+	stats.name = currentTask->name;
+	stats.interval = currentTask->interval;
+	stats.runs = currentTask->runs;
+	stats.totalMilliseconds = currentTask->totalMilliseconds;
+	stats.maxMilliseconds = currentTask->maxMilliseconds;
+	return true;
+}
+
+double scheduler::getWaitMilliseconds()
+{
+	return mWaitMilliseconds;
+}
+
+void scheduler::printStats()
+{
+	utils::debugPrint("Scheduler: %u frames, %.2fms waiting for vblank\n", mFrameCount, mWaitMilliseconds);
+	utils::debugPrint("%-12s %8s %8s %10s %8s %8s\n", "Task", "Interval", "Runs", "Total ms", "Avg ms", "Max ms");
+	for (uint32_t i = 0; i < mTaskCount; i++)
+	{
+		task* currentTask = &mTasks[i];
+		double average = currentTask->runs == 0 ? 0 : currentTask->totalMilliseconds / currentTask->runs;
+		utils::debugPrint("%-12s %8u %8u %10.2f %8.3f %8.3f\n", currentTask->name, currentTask->interval, currentTask->runs, currentTask->totalMilliseconds, average, currentTask->maxMilliseconds);
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+typedef void (*taskCallback)(void* userData);
+
+class scheduler
+{
+public:
+
+	typedef struct taskStats
+	{
+		const char* name;
+		uint32_t interval;
+		uint32_t runs;
+		double totalMilliseconds;
+		double maxMilliseconds;
+	} taskStats;
+
+	static int32_t addTask(const char* name, taskCallback callback, void* userData, uint32_t interval);
+	static void setTaskInterval(int32_t taskId, uint32_t interval);
+	static void runFrame();
+	static uint32_t getFrameCount();
+	static uint32_t getTaskCount();
+	static bool getTaskStats(int32_t taskId, taskStats& stats);
+	static double getWaitMilliseconds();
+	static void printStats();
+};
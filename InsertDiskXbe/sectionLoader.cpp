@@ -0,0 +1,111 @@
+#include "sectionLoader.h"
+#include "xbeHeader.h"
+#include "utils.h"
+
+namespace
+{
+	typedef struct sectionGroupInfo
+	{
+		const char* name;
+		const char* codeSection;
+		const char* dataSection;
+	} sectionGroupInfo;
+
+	const sectionGroupInfo mGroups[sectionGroupCount] =
+	{
+		{ "Image codec", SECTION_IMAGE_CODEC, SECTION_IMAGE_CODEC_DATA },
+		{ "Vorbis", SECTION_VORBIS, SECTION_VORBIS_DATA },
+		{ "Hash", SECTION_HASH, SECTION_HASH_DATA },
+		{ "Diagnostics", SECTION_DIAGNOSTICS, SECTION_DIAGNOSTICS_DATA }
+	};
+
+	uint32_t mReferences[sectionGroupCount];
+	uint32_t mLoads[sectionGroupCount];
+	double mLoadMilliseconds[sectionGroupCount];
+
+	uint32_t getSectionSize(const char* section)
+	{
+		HANDLE sectionHandle = XGetSectionHandle(section);
+		return sectionHandle == INVALID_HANDLE_VALUE ? 0 : XGetSectionSize(sectionHandle);
+	}
+}
+
+bool sectionLoader::load(sectionGroup group)
+{
+	if (mReferences[group] > 0)
+	{
+		mReferences[group]++;
+		return true;
+	}
+
+	uint64_t loadStart = utils::getPerformanceCounter();
+	if (XLoadSection(mGroups[group].codeSection) == NULL)
+	{
+		utils::debugPrint("Failed to load section %s\n", mGroups[group].codeSection);
+		return false;
+	}
+
+	// A group without read only data has no data section to load
+	if (XGetSectionHandle(mGroups[group].dataSection) != INVALID_HANDLE_VALUE && XLoadSection(mGroups[group].dataSection) == NULL)
+	{
+		utils::debugPrint("Failed to load section %s\n", mGroups[group].dataSection);
+		XFreeSection(mGroups[group].codeSection);
+		return false;
+	}
+
+	mLoadMilliseconds[group] += utils::getElapsedMilliseconds(loadStart, utils::getPerformanceCounter());
+	mLoads[group]++;
+	mReferences[group] = 1;
+	return true;
+}
+
+void sectionLoader::unload(sectionGroup group)
+{
+	if (mReferences[group] == 0)
+	{
+		return;
+	}
+	mReferences[group]--;
+	if (mReferences[group] > 0)
+	{
+		return;
+	}
+
+	XFreeSection(mGroups[group].codeSection);
+	if (XGetSectionHandle(mGroups[group].dataSection) != INVALID_HANDLE_VALUE)
+	{
+		XFreeSection(mGroups[group].dataSection);
+	}
+}
+
+bool sectionLoader::isLoaded(sectionGroup group)
+{
+	return mReferences[group] > 0;
+}
+
+const char* sectionLoader::getGroupString(sectionGroup group)
+{
+	if (group >= sectionGroupCount)
+	{
+		return "Unknown";
+	}
+	return mGroups[group].name;
+}
+
+void sectionLoader::printStats()
+{
+	// The running image keeps its headers mapped at the base address
+	const uint8_t* image = (const uint8_t*)XBE_BASE_ADDRESS;
+	xbeHeader::xbeInfo info;
+	if (xbeHeader::parse(image, *(const uint32_t*)(image + 0x108), info) == xbeHeader::xbeResultOk)
+	{
+		utils::debugPrint("XBE sections: %u bytes preloaded, %u bytes on demand\n", info.preloadSize, info.deferredSize);
+	}
+
+	utils::debugPrint("%-12s %10s %8s %10s\n", "Group", "Bytes", "Loads", "Load ms");
+	for (uint32_t i = 0; i < sectionGroupCount; i++)
+	{
+		uint32_t size = getSectionSize(mGroups[i].codeSection) + getSectionSize(mGroups[i].dataSection);
+		utils::debugPrint("%-12s %10u %8u %10.2f\n", mGroups[i].name, size, mLoads[i], mLoadMilliseconds[i]);
+	}
+}
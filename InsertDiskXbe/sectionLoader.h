@@ -0,0 +1,37 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+// Code and read only data of each group live in their own XBE sections,
+// imagebld is told not to preload them (see XboxImageTool in the vcproj).
+#define SECTION_IMAGE_CODEC "IMGC"
+#define SECTION_IMAGE_CODEC_DATA "IMGC_RD"
+#define SECTION_VORBIS "VORB"
+#define SECTION_VORBIS_DATA "VORB_RD"
+#define SECTION_HASH "HASH"
+#define SECTION_HASH_DATA "HASH_RD"
+#define SECTION_DIAGNOSTICS "DIAG"
+#define SECTION_DIAGNOSTICS_DATA "DIAG_RD"
+
+typedef enum sectionGroup
+{
+	sectionGroupImageCodec = 0,
+	sectionGroupVorbis = 1,
+	sectionGroupHash = 2,
+	sectionGroupDiagnostics = 3,
+	sectionGroupCount = 4
+} sectionGroup;
+
+class sectionLoader
+{
+public:
+
+	// load and unload are reference counted and main thread only, a group
+	// stays resident until the last user unloads it. Nothing placed in a
+	// group may be called before its load returns true.
+	static bool load(sectionGroup group);
+	static void unload(sectionGroup group);
+	static bool isLoaded(sectionGroup group);
+	static const char* getGroupString(sectionGroup group);
+	static void printStats();
+};
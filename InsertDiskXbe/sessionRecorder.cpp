@@ -0,0 +1,431 @@
+#include "sessionRecorder.h"
+#include "trayMonitor.h"
+#include "trayController.h"
+#include "discProbe.h"
+#include "launchResolver.h"
+#include "fileSystem.h"
+#include "driveManager.h"
+#include "utils.h"
+
+#define SESSION_DIRECTORY "E:\\InsertDiskXbe"
+#define SESSION_MAGIC 0x53455353
+#define SESSION_VERSION 2
+
+namespace
+{
+	typedef struct sessionHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t recordCount;
+	} sessionHeader;
+
+	bool mInitialized = false;
+	bool mReplaying = false;
+	bool mRecording = false;
+	volatile LONG mSaving = FALSE;
+	uint32_t mStartTime = 0;
+	CRITICAL_SECTION mLock;
+
+	sessionRecorder::sessionRecord* mRecords = NULL;
+	uint32_t mRecordCount = 0;
+	uint32_t mLastTrayState = 0xffffffff;
+	uint32_t mNextRecord[sessionEventCount];
+	uint32_t mReplayTime = 0;
+	sessionRecorder::replayStats mReplayStats;
+
+	const sessionRecorder::sessionRecord* nextRecord(sessionEvent event)
+	{
+		// Records stay loaded for the whole session so the pointer remains valid
+		const sessionRecorder::sessionRecord* result = NULL;
+		EnterCriticalSection(&mLock);
+		for (uint32_t i = mNextRecord[event]; i < mRecordCount; i++)
+		{
+			if (mRecords[i].event == (uint32_t)event)
+			{
+				result = &mRecords[i];
+				mNextRecord[event] = i + 1;
+				break;
+			}
+		}
+		if (result == NULL)
+		{
+			mReplayStats.exhausted = true;
+		}
+		LeaveCriticalSection(&mLock);
+		return result;
+	}
+
+	// Holds a replayed answer back by the time the recorded drive took to
+	// give it, measured from the previous answer of the same probe.
+	void replayDelay(const sessionRecorder::sessionRecord* record)
+	{
+		EnterCriticalSection(&mLock);
+		uint32_t delay = record->time > mReplayTime ? record->time - mReplayTime : 0;
+		mReplayTime = record->time;
+		LeaveCriticalSection(&mLock);
+		Sleep(delay);
+	}
+
+	void countDivergence()
+	{
+		EnterCriticalSection(&mLock);
+		mReplayStats.divergences++;
+		LeaveCriticalSection(&mLock);
+	}
+
+	// Only changes are recorded, repeated readings of the same state are
+	// implied by the time until the next change.
+	NTSTATUS WINAPI recordingTrayStateReader(ULONG* trayState, ULONG* ejectCount)
+	{
+		NTSTATUS status = HalReadSMCTrayState(trayState, ejectCount);
+		if (status >= 0 && *trayState != mLastTrayState)
+		{
+			mLastTrayState = *trayState;
+			sessionRecorder::record(sessionEventTrayState, *trayState, 0, NULL);
+		}
+		return status;
+	}
+
+	NTSTATUS WINAPI replayTrayStateReader(ULONG* trayState, ULONG* ejectCount)
+	{
+		uint32_t now = sessionRecorder::getSessionTime();
+		bool found = false;
+		for (uint32_t i = 0; i < mRecordCount; i++)
+		{
+			if (mRecords[i].event != sessionEventTrayState)
+			{
+				continue;
+			}
+			if (found == true && mRecords[i].time > now)
+			{
+				break;
+			}
+			*trayState = mRecords[i].value;
+			found = true;
+		}
+		if (ejectCount != NULL)
+		{
+			*ejectCount = 0;
+		}
+		return found == true ? STATUS_SUCCESS : -1;
+	}
+
+	NTSTATUS WINAPI replaySmcWriter(UCHAR address, UCHAR command, UCHAR writeWord, DWORD data)
+	{
+		utils::debugPrint("Replay skipped SMC command %02x = %u\n", command, data);
+		return STATUS_SUCCESS;
+	}
+
+	bool replayMounter(const char* driveLetter)
+	{
+		const sessionRecorder::sessionRecord* record = nextRecord(sessionEventMount);
+		if (record == NULL)
+		{
+			utils::debugPrint("Replay has no more mounts\n");
+			return false;
+		}
+		Sleep(record->data);
+		EnterCriticalSection(&mLock);
+		mReplayTime = record->time;
+		LeaveCriticalSection(&mLock);
+		return record->value == 1;
+	}
+
+	mediaType replayClassifier()
+	{
+		const sessionRecorder::sessionRecord* record = nextRecord(sessionEventMedia);
+		if (record == NULL)
+		{
+			return mediaTypeUnclassified;
+		}
+		replayDelay(record);
+		return (mediaType)record->value;
+	}
+
+	// Answers come back in the order they were asked, a different path
+	// means the probe logic has changed since the session was recorded.
+	xbeHeader::xbeResult replayXbeReader(const char* path, bool identityOnly, xbeHeader::xbeInfo& info)
+	{
+		memset(&info, 0, sizeof(xbeHeader::xbeInfo));
+		const sessionRecorder::sessionRecord* record = nextRecord(sessionEventFileExists);
+		if (record == NULL)
+		{
+			return xbeHeader::xbeResultReadFailed;
+		}
+		replayDelay(record);
+		if (strcmp(record->text, path) != 0)
+		{
+			utils::debugPrint("Replay diverged, read %s where %s was recorded\n", path, record->text);
+			countDivergence();
+		}
+		info.titleId = record->data;
+		return (xbeHeader::xbeResult)record->value;
+	}
+
+	bool replayLaunchCacheReader(const xbeHeader::xbeInfo& identity, launchCache::launchCacheEntry& entry)
+	{
+		memset(&entry, 0, sizeof(launchCache::launchCacheEntry));
+		const sessionRecorder::sessionRecord* record = nextRecord(sessionEventCacheLookup);
+		if (record == NULL || record->value == 0)
+		{
+			return false;
+		}
+		entry.titleId = record->data;
+		strncpy(entry.launchPath, record->text, LAUNCH_CACHE_MAX_PATH - 1);
+		return true;
+	}
+
+	// Targets are recorded by launch path, "D:\folder;file.xbe", which
+	// gives the xbe path back once the separator becomes a backslash.
+	pointerVector* replayTargetResolver(const char* rootPath, const char** candidates, uint32_t candidateCount)
+	{
+		pointerVector* targets = new pointerVector(true);
+		const sessionRecorder::sessionRecord* resolve = nextRecord(sessionEventResolve);
+		uint32_t targetCount = resolve != NULL ? resolve->value : 0;
+		for (uint32_t i = 0; i < targetCount; i++)
+		{
+			const sessionRecorder::sessionRecord* record = nextRecord(sessionEventLaunchTarget);
+			if (record == NULL)
+			{
+				break;
+			}
+
+			launchResolver::launchTarget* target = new launchResolver::launchTarget();
+			target->launchPath = strdup(record->text);
+			target->xbePath = strdup(record->text);
+			char* separator = strchr(target->xbePath, ';');
+			if (separator != NULL && separator > target->xbePath && separator[-1] == '\\')
+			{
+				memmove(separator, separator + 1, strlen(separator));
+			}
+			else if (separator != NULL)
+			{
+				*separator = '\\';
+			}
+			target->confirmed = record->value == 1;
+			targets->add(target);
+		}
+		return targets;
+	}
+
+	bool loadReplay(const char* path)
+	{
+		if (mRecords == NULL)
+		{
+			mRecords = (sessionRecorder::sessionRecord*)malloc(SESSION_MAX_RECORDS * sizeof(sessionRecorder::sessionRecord));
+		}
+
+		uint32_t fileHandle;
+		if (fileSystem::fileOpen(path, fileSystem::FileModeRead, fileHandle) == false)
+		{
+			return false;
+		}
+
+		sessionHeader header;
+		uint32_t bytesRead = 0;
+		bool result = fileSystem::fileRead(fileHandle, (char*)&header, sizeof(sessionHeader), bytesRead) && bytesRead == sizeof(sessionHeader);
+		if (result == true && header.magic == SESSION_MAGIC && header.version == SESSION_VERSION && header.recordCount <= SESSION_MAX_RECORDS)
+		{
+			uint32_t recordsSize = header.recordCount * sizeof(sessionRecorder::sessionRecord);
+			result = fileSystem::fileRead(fileHandle, (char*)mRecords, recordsSize, bytesRead) && bytesRead == recordsSize;
+			mRecordCount = result == true ? header.recordCount : 0;
+		}
+		else
+		{
+			result = false;
+		}
+		fileSystem::fileClose(fileHandle);
+		return result;
+	}
+
+	DWORD WINAPI saveThread(LPVOID param)
+	{
+		sessionRecorder::save();
+		InterlockedExchange(&mSaving, FALSE);
+		return 0;
+	}
+}
+
+bool sessionRecorder::init()
+{
+	if (mInitialized == true)
+	{
+		return true;
+	}
+	mInitialized = true;
+
+	InitializeCriticalSection(&mLock);
+	mStartTime = GetTickCount();
+
+	driveManager::mountDrive("E");
+	if (startReplay(SESSION_REPLAY_PATH) == true)
+	{
+		return true;
+	}
+
+	bool recordFlag = false;
+	if (fileSystem::fileExists(SESSION_RECORD_FLAG_PATH, recordFlag) == false || recordFlag == false)
+	{
+		return true;
+	}
+
+	utils::debugPrint("Recording session to %s\n", SESSION_RECORD_PATH);
+	mRecords = (sessionRecorder::sessionRecord*)malloc(SESSION_MAX_RECORDS * sizeof(sessionRecord));
+	if (mRecords == NULL)
+	{
+		return false;
+	}
+	mRecording = true;
+	trayMonitor::setTrayStateReader(recordingTrayStateReader);
+	return true;
+}
+
+bool sessionRecorder::startReplay(const char* path)
+{
+	if (mInitialized == false || loadReplay(path) == false)
+	{
+		return false;
+	}
+
+	utils::debugPrint("Replaying %u session records from %s\n", mRecordCount, path);
+	EnterCriticalSection(&mLock);
+	memset(mNextRecord, 0, sizeof(mNextRecord));
+	memset(&mReplayStats, 0, sizeof(mReplayStats));
+	mReplayTime = 0;
+	LeaveCriticalSection(&mLock);
+	mStartTime = GetTickCount();
+	mReplaying = true;
+	mRecording = false;
+
+	trayMonitor::setTrayStateReader(replayTrayStateReader);
+	trayController::setSmcWriter(replaySmcWriter);
+	discProbe::setMounter(replayMounter);
+	discProbe::setClassifier(replayClassifier);
+	discProbe::setXbeReader(replayXbeReader);
+	discProbe::setLaunchCacheReader(replayLaunchCacheReader);
+	discProbe::setTargetResolver(replayTargetResolver);
+	return true;
+}
+
+bool sessionRecorder::isReplaying()
+{
+	return mReplaying;
+}
+
+bool sessionRecorder::isRecording()
+{
+	return mRecording;
+}
+
+uint32_t sessionRecorder::getSessionTime()
+{
+	return GetTickCount() - mStartTime;
+}
+
+void sessionRecorder::record(sessionEvent event, uint32_t value, uint32_t data, const char* text)
+{
+	if (mInitialized == false)
+	{
+		return;
+	}
+
+	if (mReplaying == true)
+	{
+		if (event != sessionEventProbe)
+		{
+			return;
+		}
+		const sessionRecord* recorded = nextRecord(sessionEventProbe);
+		EnterCriticalSection(&mLock);
+		uint32_t probes = ++mReplayStats.probes;
+		LeaveCriticalSection(&mLock);
+		if (recorded == NULL || recorded->value != value || recorded->data != data || strncmp(recorded->text, text != NULL ? text : "", sizeof(recorded->text) - 1) != 0)
+		{
+			utils::debugPrint("Replay diverged, probe %u gave %u %08x %s\n", probes, value, data, text != NULL ? text : "");
+			countDivergence();
+		}
+		return;
+	}
+
+	if (mRecording == false)
+	{
+		return;
+	}
+
+	EnterCriticalSection(&mLock);
+	if (mRecordCount < SESSION_MAX_RECORDS)
+	{
+		sessionRecord* record = &mRecords[mRecordCount++];
+		memset(record, 0, sizeof(sessionRecord));
+		record->time = getSessionTime();
+		record->event = event;
+		record->value = value;
+		record->data = data;
+		if (text != NULL)
+		{
+			strncpy(record->text, text, sizeof(record->text) - 1);
+		}
+	}
+	LeaveCriticalSection(&mLock);
+}
+
+void sessionRecorder::getReplayStats(replayStats& stats)
+{
+	if (mInitialized == false)
+	{
+		memset(&stats, 0, sizeof(replayStats));
+		return;
+	}
+	EnterCriticalSection(&mLock);
+	stats = mReplayStats;
+	LeaveCriticalSection(&mLock);
+}
+
+bool sessionRecorder::save()
+{
+	if (mRecording == false)
+	{
+		return false;
+	}
+	if (fileSystem::directoryCreate(SESSION_DIRECTORY) == false)
+	{
+		return false;
+	}
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(SESSION_RECORD_PATH, fileSystem::FileModeWrite, fileHandle) == false)
+	{
+		return false;
+	}
+
+	// Records are only ever appended, so those counted here can be written
+	// without holding up the threads still recording
+	EnterCriticalSection(&mLock);
+	sessionHeader header;
+	header.magic = SESSION_MAGIC;
+	header.version = SESSION_VERSION;
+	header.recordCount = mRecordCount;
+	LeaveCriticalSection(&mLock);
+
+	uint32_t bytesWritten = 0;
+	bool result = fileSystem::fileWrite(fileHandle, (char*)&header, sizeof(sessionHeader), bytesWritten);
+	result = result && fileSystem::fileWrite(fileHandle, (char*)mRecords, header.recordCount * sizeof(sessionRecord), bytesWritten);
+	fileSystem::fileClose(fileHandle);
+	return result;
+}
+
+void sessionRecorder::saveInBackground()
+{
+	if (mRecording == false || InterlockedCompareExchange(&mSaving, TRUE, FALSE) != FALSE)
+	{
+		return;
+	}
+	HANDLE thread = CreateThread(NULL, 0, saveThread, NULL, 0, NULL);
+	if (thread == NULL)
+	{
+		InterlockedExchange(&mSaving, FALSE);
+		return;
+	}
+	CloseHandle(thread);
+}
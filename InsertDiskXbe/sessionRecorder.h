@@ -0,0 +1,69 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define SESSION_RECORD_PATH "E:\\InsertDiskXbe\\session.rec"
+#define SESSION_REPLAY_PATH "E:\\InsertDiskXbe\\replay.rec"
+#define SESSION_RECORD_FLAG_PATH "E:\\InsertDiskXbe\\record.flag"
+#define SESSION_MAX_RECORDS 1024
+
+typedef enum sessionEvent
+{
+	sessionEventTrayState = 0,
+	sessionEventMount = 1,
+	sessionEventMedia = 2,
+	sessionEventFileExists = 3,
+	sessionEventProbe = 4,
+	sessionEventCacheLookup = 5,
+	sessionEventResolve = 6,
+	sessionEventLaunchTarget = 7,
+	sessionEventCount = 8
+} sessionEvent;
+
+typedef enum sessionProbeResult
+{
+	sessionProbeRejected = 0,
+	sessionProbeLaunch = 1,
+	sessionProbeVerify = 2
+} sessionProbeResult;
+
+class sessionRecorder
+{
+public:
+
+	typedef struct sessionRecord
+	{
+		uint32_t time;
+		uint32_t event;
+		uint32_t value;
+		uint32_t data;
+		char text[128];
+	} sessionRecord;
+
+	typedef struct replayStats
+	{
+		uint32_t probes;
+		uint32_t divergences;
+		bool exhausted;
+	} replayStats;
+
+	// Replays a session when SESSION_REPLAY_PATH exists, otherwise records
+	// to SESSION_RECORD_PATH only when SESSION_RECORD_FLAG_PATH exists, a
+	// normal boot allocates and writes nothing. Replay swaps the tray
+	// reader, SMC writer and discProbe seams so the main loop and the probe
+	// run unchanged on recorded answers, with the recorded drive latency,
+	// without the drive.
+	static bool init();
+	static bool startReplay(const char* path);
+	static bool isReplaying();
+	static bool isRecording();
+	static uint32_t getSessionTime();
+	// While replaying only probe results are taken, each is compared with
+	// the recorded one and a mismatch counts as a divergence.
+	static void record(sessionEvent event, uint32_t value, uint32_t data, const char* text);
+	static void getReplayStats(replayStats& stats);
+	static bool save();
+	// Saves on its own thread for callers that must not block on E:, a
+	// save already in progress is not repeated.
+	static void saveInBackground();
+};
@@ -0,0 +1,172 @@
+#include "spriteBatch.h"
+#include "vertexRing.h"
+#include "deviceState.h"
+#include "commandList.h"
+
+namespace
+{
+	// Quads are queued compact and only expanded to vertices when flushed,
+	// into the recorded stream and from there the vertex ring the GPU reads
+	typedef struct quad
+	{
+		math::vec3F position;
+		math::sizeF size;
+		math::rectF uvRect;
+		uint32_t color;
+	} quad;
+
+	typedef struct textureBatch
+	{
+		D3DTexture* texture;
+		quad* quads;
+		uint32_t quadCount;
+		uint32_t quadCapacity;
+	} textureBatch;
+
+	// Quad storage is kept between frames and only ever grows
+	textureBatch mBatches[SPRITE_BATCH_MAX_TEXTURES];
+	uint32_t mBatchCount = 0;
+	spriteBatch::batchStats mStats = { 0 };
+	uint32_t mFrameDrawCalls = 0;
+	uint32_t mFrameQuads = 0;
+
+	textureBatch* findBatch(D3DTexture* texture)
+	{
+		for (uint32_t i = 0; i < mBatchCount; i++)
+		{
+			if (mBatches[i].texture == texture)
+			{
+				return &mBatches[i];
+			}
+		}
+		if (mBatchCount == SPRITE_BATCH_MAX_TEXTURES)
+		{
+			return NULL;
+		}
+
+		textureBatch* batch = &mBatches[mBatchCount++];
+		batch->texture = texture;
+		batch->quadCount = 0;
+		return batch;
+	}
+
+	bool reserveQuad(textureBatch* batch)
+	{
+		if (batch->quadCount < batch->quadCapacity)
+		{
+			return true;
+		}
+		uint32_t quadCapacity = batch->quadCapacity == 0 ? SPRITE_BATCH_INITIAL_QUADS : batch->quadCapacity * 2;
+		quad* quads = (quad*)realloc(batch->quads, quadCapacity * sizeof(quad));
+		if (quads == NULL)
+		{
+			return false;
+		}
+		batch->quads = quads;
+		batch->quadCapacity = quadCapacity;
+		return true;
+	}
+
+	void drawBatch(textureBatch* batch)
+	{
+		deviceState::setTexture(0, batch->texture);
+		for (uint32_t first = 0; first < batch->quadCount; first += SPRITE_BATCH_MAX_QUADS_PER_DRAW)
+		{
+			uint32_t quadCount = min(batch->quadCount - first, (uint32_t)SPRITE_BATCH_MAX_QUADS_PER_DRAW);
+			uint32_t vertexCount = quadCount * QUAD_VERTEX_COUNT;
+			uint32_t startVertex = 0;
+			meshUtility::colorVertex* ringVertices = (meshUtility::colorVertex*)vertexRing::allocate(vertexCount, sizeof(meshUtility::colorVertex), startVertex);
+			if (ringVertices == NULL)
+			{
+				break;
+			}
+
+			// Written straight into the ring, a captured frame fills its
+			// copy in the stream and streams that on into the ring
+			meshUtility::colorVertex* vertices = ringVertices;
+			if (commandList::isCapturing() == true)
+			{
+				meshUtility::colorVertex* streamVertices = (meshUtility::colorVertex*)commandList::setVertices(vertexCount, sizeof(meshUtility::colorVertex));
+				if (streamVertices != NULL)
+				{
+					vertices = streamVertices;
+				}
+			}
+			for (uint32_t i = 0; i < quadCount; i++)
+			{
+				const quad* current = &batch->quads[first + i];
+				meshUtility::fillQuadXY(vertices + (i * QUAD_VERTEX_COUNT), current->position, current->size, current->uvRect, current->color);
+			}
+			if (vertices != ringVertices)
+			{
+				memcpy(ringVertices, vertices, vertexCount * sizeof(meshUtility::colorVertex));
+			}
+			quadIndexBuffer::bind(startVertex);
+			commandList::drawIndexed(D3DPT_TRIANGLELIST, 0, vertexCount, 0, quadCount * 2);
+			mFrameDrawCalls++;
+		}
+		mFrameQuads += batch->quadCount;
+		batch->quadCount = 0;
+	}
+}
+
+void spriteBatch::addQuad(D3DTexture* texture, const math::vec3F& position, const math::sizeF& size, const math::rectF& uvRect, uint32_t color)
+{
+	textureBatch* batch = findBatch(texture);
+	if (batch == NULL)
+	{
+		// Out of texture slots, make room by drawing what is queued
+		flush();
+		batch = findBatch(texture);
+	}
+	if (reserveQuad(batch) == false)
+	{
+		return;
+	}
+	quad* current = &batch->quads[batch->quadCount++];
+	current->position = position;
+	current->size = size;
+	current->uvRect = uvRect;
+	current->color = color;
+}
+
+void spriteBatch::flush()
+{
+	if (mBatchCount == 0)
+	{
+		return;
+	}
+
+	// Tint comes from the per vertex diffuse instead of TEXTUREFACTOR
+	// so every quad on a texture can share one draw. State is left as is
+	// afterwards, deviceState drops it again on every later flush.
+	deviceState::setVertexShader(D3DFVF_COLORVERTEX);
+	vertexRing::bind(sizeof(meshUtility::colorVertex));
+	deviceState::setTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+	deviceState::setTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
+
+	for (uint32_t i = 0; i < mBatchCount; i++)
+	{
+		drawBatch(&mBatches[i]);
+	}
+	mBatchCount = 0;
+}
+
+void spriteBatch::endFrame()
+{
+	flush();
+	mStats.frames++;
+	mStats.drawCalls += mFrameDrawCalls;
+	mStats.quads += mFrameQuads;
+	mStats.vertices += mFrameQuads * QUAD_VERTEX_COUNT;
+	mStats.lastFrameDrawCalls = mFrameDrawCalls;
+	mStats.lastFrameQuads = mFrameQuads;
+	mStats.lastFrameVertices = mFrameQuads * QUAD_VERTEX_COUNT;
+	mFrameDrawCalls = 0;
+	mFrameQuads = 0;
+}
+
+void spriteBatch::getStats(batchStats& stats)
+{
+	stats = mStats;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "meshUtility.h"
+#include "quadIndexBuffer.h"
+#include "xboxinternals.h"
+
+#define SPRITE_BATCH_MAX_TEXTURES 16
+#define SPRITE_BATCH_INITIAL_QUADS 64
+#define SPRITE_BATCH_MAX_QUADS_PER_DRAW QUAD_INDEX_MAX_QUADS
+
+class spriteBatch
+{
+public:
+
+	typedef struct batchStats
+	{
+		uint32_t frames;
+		uint32_t drawCalls;
+		uint32_t quads;
+		uint32_t vertices;
+		uint32_t lastFrameDrawCalls;
+		uint32_t lastFrameQuads;
+		uint32_t lastFrameVertices;
+	} batchStats;
+
+	// Quads are grouped per texture and drawn in first use order when
+	// flushed, so quads on different textures only keep their relative
+	// order across an explicit flush. endFrame flushes and closes the
+	// frame counters, drawing::endFrame calls it before EndScene.
+	static void addQuad(D3DTexture* texture, const math::vec3F& position, const math::sizeF& size, const math::rectF& uvRect, uint32_t color);
+	static void flush();
+	static void endFrame();
+	static void getStats(batchStats& stats);
+};
@@ -0,0 +1,165 @@
+#include "startupTimeline.h"
+#include "fileSystem.h"
+#include "sectionLoader.h"
+#include "stringUtility.h"
+#include "utils.h"
+
+#define STARTUP_TIMELINE_DIRECTORY "E:\\InsertDiskXbe"
+
+namespace
+{
+	typedef struct span
+	{
+		const char* name;
+		uint32_t detail;
+		uint64_t start;
+		uint64_t end;
+		bool ended;
+	} span;
+
+	span mSpans[STARTUP_TIMELINE_MAX_SPANS];
+	LONG mSpanCount = 0;
+	LONG mRecording = FALSE;
+	uint64_t mOrigin = 0;
+
+	// The table is written once per boot, so its code is loaded on demand
+#pragma code_seg("DIAG")
+#pragma const_seg("DIAG_RD")
+
+	// Every line goes to debug output and, when open, the timeline file
+	void emitLine(uint32_t fileHandle, bool fileOpen, char* line)
+	{
+		utils::debugPrint("%s", line);
+		if (fileOpen == true)
+		{
+			uint32_t bytesWritten = 0;
+			fileSystem::fileWrite(fileHandle, line, (uint32_t)strlen(line), bytesWritten);
+		}
+		free(line);
+	}
+
+	void emitTotals(uint32_t fileHandle, bool fileOpen, uint32_t spanCount)
+	{
+		for (uint32_t i = 0; i < spanCount; i++)
+		{
+			// Only the first span of a repeated name reports the total
+			bool first = true;
+			for (uint32_t j = 0; j < i && first == true; j++)
+			{
+				first = strcmp(mSpans[i].name, mSpans[j].name) != 0;
+			}
+			if (first == false)
+			{
+				continue;
+			}
+
+			uint32_t count = 0;
+			double total = 0;
+			for (uint32_t j = i; j < spanCount; j++)
+			{
+				if (mSpans[j].ended == true && strcmp(mSpans[i].name, mSpans[j].name) == 0)
+				{
+					count++;
+					total += utils::getElapsedMilliseconds(mSpans[j].start, mSpans[j].end);
+				}
+			}
+			if (count > 1)
+			{
+				emitLine(fileHandle, fileOpen, stringUtility::formatString("%-20s %10u %10s %10.3f\r\n", mSpans[i].name, count, "total", total));
+			}
+		}
+	}
+
+	void writeTable(uint32_t spanCount)
+	{
+		uint32_t fileHandle = 0;
+		bool fileOpen = fileSystem::directoryCreate(STARTUP_TIMELINE_DIRECTORY) && fileSystem::fileOpen(STARTUP_TIMELINE_PATH, fileSystem::FileModeWrite, fileHandle);
+
+		emitLine(fileHandle, fileOpen, stringUtility::formatString("Startup timeline (ms from XBE entry)\r\n"));
+		emitLine(fileHandle, fileOpen, stringUtility::formatString("%-20s %10s %10s %10s\r\n", "Phase", "Detail", "Start", "Duration"));
+		for (uint32_t i = 0; i < spanCount; i++)
+		{
+			span* currentSpan = &mSpans[i];
+			double start = utils::getElapsedMilliseconds(mOrigin, currentSpan->start);
+			if (currentSpan->ended == false)
+			{
+				emitLine(fileHandle, fileOpen, stringUtility::formatString("%-20s %10u %10.3f %10s\r\n", currentSpan->name, currentSpan->detail, start, "running"));
+				continue;
+			}
+			double duration = utils::getElapsedMilliseconds(currentSpan->start, currentSpan->end);
+			emitLine(fileHandle, fileOpen, stringUtility::formatString("%-20s %10u %10.3f %10.3f\r\n", currentSpan->name, currentSpan->detail, start, duration));
+		}
+		emitTotals(fileHandle, fileOpen, spanCount);
+
+		if (fileOpen == true)
+		{
+			fileSystem::fileClose(fileHandle);
+		}
+	}
+
+#pragma const_seg()
+#pragma code_seg()
+}
+
+void startupTimeline::init()
+{
+	mOrigin = utils::getPerformanceCounter();
+	mSpanCount = 0;
+	InterlockedExchange(&mRecording, TRUE);
+	mark("XBE entry", 0);
+}
+
+int32_t startupTimeline::begin(const char* name, uint32_t detail)
+{
+	if (mRecording == FALSE)
+	{
+		return -1;
+	}
+
+	LONG spanId = InterlockedIncrement(&mSpanCount) - 1;
+	if (spanId >= STARTUP_TIMELINE_MAX_SPANS)
+	{
+		return -1;
+	}
+
+	span* currentSpan = &mSpans[spanId];
+	currentSpan->name = name;
+	currentSpan->detail = detail;
+	currentSpan->ended = false;
+	currentSpan->start = utils::getPerformanceCounter();
+	return spanId;
+}
+
+void startupTimeline::end(int32_t spanId)
+{
+	if (spanId < 0 || spanId >= STARTUP_TIMELINE_MAX_SPANS)
+	{
+		return;
+	}
+	mSpans[spanId].end = utils::getPerformanceCounter();
+	mSpans[spanId].ended = true;
+}
+
+void startupTimeline::mark(const char* name, uint32_t detail)
+{
+	end(begin(name, detail));
+}
+
+bool startupTimeline::isRecording()
+{
+	return mRecording == TRUE;
+}
+
+void startupTimeline::complete()
+{
+	if (InterlockedExchange(&mRecording, FALSE) == FALSE)
+	{
+		return;
+	}
+	if (sectionLoader::load(sectionGroupDiagnostics) == false)
+	{
+		return;
+	}
+	writeTable(min((uint32_t)mSpanCount, (uint32_t)STARTUP_TIMELINE_MAX_SPANS));
+	sectionLoader::unload(sectionGroupDiagnostics);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define STARTUP_TIMELINE_MAX_SPANS 512
+#define STARTUP_TIMELINE_PATH "E:\\InsertDiskXbe\\startup.txt"
+
+class startupTimeline
+{
+public:
+
+	// Spans are timed from init, which marks XBE entry. begin may be called
+	// from any thread and returns -1 once the timeline is full or complete,
+	// end ignores -1. complete prints the table, writes it to
+	// STARTUP_TIMELINE_PATH and stops recording.
+	static void init();
+	static int32_t begin(const char* name, uint32_t detail);
+	static void end(int32_t spanId);
+	static void mark(const char* name, uint32_t detail);
+	static bool isRecording();
+	static void complete();
+};
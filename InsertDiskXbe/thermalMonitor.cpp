@@ -0,0 +1,114 @@
+#include "thermalMonitor.h"
+#include "traceRing.h"
+#include "utils.h"
+
+namespace
+{
+	thermalLevel mLevel = thermalLevelNormal;
+	thermalMonitor::thermalSample mLastSample = { 0 };
+	uint32_t mLastTracedSample = 0;
+
+	bool readRegister(uint32_t command, uint32_t& value)
+	{
+		DWORD data = 0;
+		if (HalReadSMBusByte(PIC_ADDRESS, (UCHAR)command, &data) < 0)
+		{
+			return false;
+		}
+		value = data & 0xff;
+		return true;
+	}
+
+	thermalLevel calculateLevel(uint32_t temperature)
+	{
+		uint32_t hot = THERMAL_HOT_TEMPERATURE;
+		uint32_t warm = THERMAL_WARM_TEMPERATURE;
+		if (mLevel == thermalLevelHot)
+		{
+			hot -= THERMAL_HYSTERESIS;
+		}
+		if (mLevel >= thermalLevelWarm)
+		{
+			warm -= THERMAL_HYSTERESIS;
+		}
+
+		if (temperature >= hot)
+		{
+			return thermalLevelHot;
+		}
+		if (temperature >= warm)
+		{
+			return thermalLevelWarm;
+		}
+		return thermalLevelNormal;
+	}
+}
+
+bool thermalMonitor::sample()
+{
+	thermalSample sample;
+	if (readRegister(CPU_TEMP, sample.cpuTemperature) == false || readRegister(MB_TEMP, sample.boardTemperature) == false)
+	{
+		return false;
+	}
+	if (readRegister(FAN_READBACK, sample.fanSpeed) == false)
+	{
+		sample.fanSpeed = 0;
+	}
+	mLastSample = sample;
+
+	// Only samples that differ from the last traced one are written
+	uint32_t packedSample = sample.cpuTemperature | (sample.boardTemperature << 8) | (sample.fanSpeed << 16);
+	if (packedSample != mLastTracedSample)
+	{
+		traceRing::write(traceEventThermalSample, packedSample);
+		mLastTracedSample = packedSample;
+	}
+
+	thermalLevel level = calculateLevel(max(sample.cpuTemperature, sample.boardTemperature));
+	if (level == mLevel)
+	{
+		return false;
+	}
+
+	utils::debugPrint("Thermal level %s, cpu %uC, board %uC, fan %u\n", getLevelString(level), sample.cpuTemperature, sample.boardTemperature, sample.fanSpeed);
+	traceRing::write(traceEventThermalThrottle, level);
+	mLevel = level;
+	return true;
+}
+
+thermalLevel thermalMonitor::getLevel()
+{
+	return mLevel;
+}
+
+void thermalMonitor::getLastSample(thermalSample& sample)
+{
+	sample = mLastSample;
+}
+
+uint32_t thermalMonitor::getThrottleScale()
+{
+	if (mLevel == thermalLevelHot)
+	{
+		return 4;
+	}
+	if (mLevel == thermalLevelWarm)
+	{
+		return 2;
+	}
+	return 1;
+}
+
+const char* thermalMonitor::getLevelString(thermalLevel level)
+{
+	if (level == thermalLevelHot)
+	{
+		return "Hot";
+	}
+	if (level == thermalLevelWarm)
+	{
+		return "Warm";
+	}
+	return "Normal";
+}
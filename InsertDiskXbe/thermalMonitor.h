@@ -0,0 +1,34 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define THERMAL_WARM_TEMPERATURE 50
+#define THERMAL_HOT_TEMPERATURE 60
+#define THERMAL_HYSTERESIS 3
+
+typedef enum thermalLevel
+{
+	thermalLevelNormal = 0,
+	thermalLevelWarm = 1,
+	thermalLevelHot = 2
+} thermalLevel;
+
+class thermalMonitor
+{
+public:
+
+	typedef struct thermalSample
+	{
+		uint32_t cpuTemperature;
+		uint32_t boardTemperature;
+		uint32_t fanSpeed;
+	} thermalSample;
+
+	// Reads the PIC over SMBus, returns true when the throttle level changed.
+	// Levels only drop once the hotter sensor is THERMAL_HYSTERESIS below.
+	static bool sample();
+	static thermalLevel getLevel();
+	static void getLastSample(thermalSample& sample);
+	static uint32_t getThrottleScale();
+	static const char* getLevelString(thermalLevel level);
+};
@@ -0,0 +1,338 @@
+#include "traceRing.h"
+#include "utils.h"
+
+#define TRACE_RING_MAGIC 0x45435254
+#define TRACE_RING_VERSION 1
+#define TRACE_RECORD_MAX_SIZE 21
+
+namespace
+{
+	typedef struct traceHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t dataSize;
+		uint32_t head;
+		uint32_t used;
+		uint32_t boots;
+		uint64_t tailTime;
+		uint64_t headTime;
+	} traceHeader;
+
+	typedef struct traceRecord
+	{
+		uint32_t event;
+		uint64_t delta;
+		uint64_t value;
+		uint32_t length;
+	} traceRecord;
+
+	// Only ever touched from the main thread, no locking required
+	traceHeader* mHeader = NULL;
+	uint8_t* mData = NULL;
+
+	uint64_t getSystemTimeMilliseconds()
+	{
+		LARGE_INTEGER systemTime;
+		KeQuerySystemTime(&systemTime);
+		return (uint64_t)systemTime.QuadPart / 10000;
+	}
+
+	uint32_t encodeVarint(uint64_t value, uint8_t* buffer)
+	{
+		uint32_t length = 0;
+		while (value >= 0x80)
+		{
+			buffer[length++] = (uint8_t)(value | 0x80);
+			value >>= 7;
+		}
+		buffer[length++] = (uint8_t)value;
+		return length;
+	}
+
+	bool decodeVarint(uint32_t offset, uint32_t available, uint64_t& value, uint32_t& length)
+	{
+		value = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 7)
+		{
+			if (length >= available)
+			{
+				return false;
+			}
+			uint8_t byte = mData[(offset + length) % mHeader->dataSize];
+			length++;
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool decodeRecord(uint32_t offset, uint32_t available, traceRecord& record)
+	{
+		if (available == 0)
+		{
+			return false;
+		}
+		record.event = mData[offset % mHeader->dataSize];
+		record.length = 1;
+		if (record.event >= traceEventCount)
+		{
+			return false;
+		}
+		return decodeVarint(offset, available, record.delta, record.length) && decodeVarint(offset, available, record.value, record.length);
+	}
+
+	uint32_t getTail()
+	{
+		return (mHeader->head + mHeader->dataSize - mHeader->used) % mHeader->dataSize;
+	}
+
+	bool validateRing()
+	{
+		if (mHeader->magic != TRACE_RING_MAGIC || mHeader->version != TRACE_RING_VERSION || mHeader->dataSize != TRACE_RING_SIZE - sizeof(traceHeader))
+		{
+			return false;
+		}
+		if (mHeader->head >= mHeader->dataSize || mHeader->used > mHeader->dataSize)
+		{
+			return false;
+		}
+
+		// Walk every record so a ring scribbled over by a title is discarded
+		uint32_t offset = getTail();
+		uint32_t remaining = mHeader->used;
+		uint64_t time = mHeader->tailTime;
+		while (remaining > 0)
+		{
+			traceRecord record;
+			if (decodeRecord(offset, remaining, record) == false)
+			{
+				return false;
+			}
+			time += record.delta;
+			offset = (offset + record.length) % mHeader->dataSize;
+			remaining -= record.length;
+		}
+		return time == mHeader->headTime;
+	}
+
+	void resetRing()
+	{
+		memset(mHeader, 0, sizeof(traceHeader));
+		mHeader->magic = TRACE_RING_MAGIC;
+		mHeader->version = TRACE_RING_VERSION;
+		mHeader->dataSize = TRACE_RING_SIZE - sizeof(traceHeader);
+	}
+
+	void dropOldestRecord()
+	{
+		traceRecord record;
+		if (decodeRecord(getTail(), mHeader->used, record) == false)
+		{
+			mHeader->used = 0;
+			return;
+		}
+		mHeader->tailTime += record.delta;
+		mHeader->used -= record.length;
+	}
+}
+
+bool traceRing::init()
+{
+	if (mHeader != NULL)
+	{
+		return true;
+	}
+
+	// Allocation fails when the pages are still held over from a previous
+	// boot. That can only be our ring after a quick reboot, which is when
+	// the kernel hands us a LaunchDataPage, on a cold boot the pages belong
+	// to someone else and tracing is disabled rather than writing over them.
+	bool mapped = false;
+	void* memory = MmAllocateContiguousMemoryEx(TRACE_RING_SIZE, TRACE_RING_PHYSICAL_ADDRESS, TRACE_RING_PHYSICAL_ADDRESS + TRACE_RING_SIZE - 1, 0x1000, PAGE_READWRITE);
+	if (memory == NULL && LaunchDataPage != NULL)
+	{
+		memory = MmMapIoSpace(TRACE_RING_PHYSICAL_ADDRESS, TRACE_RING_SIZE, PAGE_READWRITE);
+		mapped = true;
+	}
+	if (memory == NULL)
+	{
+		utils::debugPrint("Trace ring at %08x is in use, tracing disabled\n", TRACE_RING_PHYSICAL_ADDRESS);
+		return false;
+	}
+
+	mHeader = (traceHeader*)memory;
+	mData = (uint8_t*)memory + sizeof(traceHeader);
+
+	if (validateRing() == true)
+	{
+		dump();
+	}
+	else if (mapped == true)
+	{
+		// Held pages that are not a ring were persisted by a title, leave them be
+		utils::debugPrint("Trace ring at %08x holds foreign data, tracing disabled\n", TRACE_RING_PHYSICAL_ADDRESS);
+		MmUnmapIoSpace(memory, TRACE_RING_SIZE);
+		mHeader = NULL;
+		mData = NULL;
+		return false;
+	}
+	else
+	{
+		resetRing();
+	}
+	MmPersistContiguousMemory(memory, TRACE_RING_SIZE, TRUE);
+
+	mHeader->boots++;
+	write(traceEventBoot, mHeader->boots);
+	return true;
+}
+
+void traceRing::write(traceEvent event, uint32_t value)
+{
+	if (mHeader == NULL)
+	{
+		return;
+	}
+
+	uint64_t now = getSystemTimeMilliseconds();
+	if (mHeader->used == 0)
+	{
+		mHeader->tailTime = now;
+		mHeader->headTime = now;
+	}
+
+	// System time can step backwards when the clock is set, clamp to zero
+	uint64_t delta = now > mHeader->headTime ? now - mHeader->headTime : 0;
+
+	uint8_t record[TRACE_RECORD_MAX_SIZE];
+	uint32_t length = 0;
+	record[length++] = (uint8_t)event;
+	length += encodeVarint(delta, record + length);
+	length += encodeVarint(value, record + length);
+
+	while (mHeader->used + length > mHeader->dataSize)
+	{
+		dropOldestRecord();
+	}
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		mData[mHeader->head] = record[i];
+		mHeader->head = (mHeader->head + 1) % mHeader->dataSize;
+	}
+	mHeader->used += length;
+	mHeader->headTime += delta;
+}
+
+void traceRing::dump()
+{
+	if (mHeader == NULL)
+	{
+		return;
+	}
+
+	utils::debugPrint("Trace ring: %u bytes used, %u boots\n", mHeader->used, mHeader->boots);
+
+	uint32_t offset = getTail();
+	uint32_t remaining = mHeader->used;
+	uint64_t time = mHeader->tailTime;
+	uint64_t swapTime = 0;
+	uint64_t launchTime = 0;
+	uint32_t launchTitleId = 0;
+	bool swapped = false;
+	bool launched = false;
+	while (remaining > 0)
+	{
+		traceRecord record;
+		if (decodeRecord(offset, remaining, record) == false)
+		{
+			break;
+		}
+		time += record.delta;
+		offset = (offset + record.length) % mHeader->dataSize;
+		remaining -= record.length;
+
+		utils::debugPrint("%10u ms %-16s 0x%08x\n", (uint32_t)(time - mHeader->tailTime), getEventString((traceEvent)record.event), (uint32_t)record.value);
+
+		// A disc swap starts when the tray begins closing on the new disc
+		if (record.event == traceEventTrayState && record.value == SMC_TRAY_STATE_CLOSING)
+		{
+			swapTime = time;
+			swapped = true;
+		}
+		else if (record.event == traceEventTrayState && (record.value == SMC_TRAY_STATE_OPENING || record.value == SMC_TRAY_STATE_OPEN))
+		{
+			swapped = false;
+		}
+
+		// The launch record is written just before HalReturnToFirmware, the
+		// last point this xbe sees before the title boots. The title's own
+		// start is invisible from here, so the swap is timed to the launch and
+		// the title's session is reported from the launch to the next boot,
+		// which also spans the reboots into the title and back.
+		if (record.event == traceEventLaunch && swapped == true)
+		{
+			utils::debugPrint("Disc swap to launch of %08x: %u ms\n", (uint32_t)record.value, (uint32_t)(time - swapTime));
+			swapped = false;
+		}
+		if (record.event == traceEventBoot && launched == true)
+		{
+			utils::debugPrint("Title %08x launch to next boot: %u ms\n", launchTitleId, (uint32_t)(time - launchTime));
+		}
+		launched = record.event == traceEventLaunch;
+		if (launched == true)
+		{
+			launchTime = time;
+			launchTitleId = (uint32_t)record.value;
+		}
+	}
+}
+
+const char* traceRing::getEventString(traceEvent event)
+{
+	if (event == traceEventBoot)
+	{
+		return "Boot";
+	}
+	if (event == traceEventTrayState)
+	{
+		return "Tray state";
+	}
+	if (event == traceEventDriveMounted)
+	{
+		return "Drive mounted";
+	}
+	if (event == traceEventXbeProbed)
+	{
+		return "XBE probed";
+	}
+	if (event == traceEventDiscRejected)
+	{
+		return "Disc rejected";
+	}
+	if (event == traceEventDriveStalled)
+	{
+		return "Drive stalled";
+	}
+	if (event == traceEventLaunch)
+	{
+		return "Launch";
+	}
+	if (event == traceEventMediaClassified)
+	{
+		return "Media classified";
+	}
+	if (event == traceEventThermalSample)
+	{
+		return "Thermal sample";
+	}
+	if (event == traceEventThermalThrottle)
+	{
+		return "Thermal throttle";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define TRACE_RING_PHYSICAL_ADDRESS 0x03C00000
+#define TRACE_RING_SIZE 0x4000
+
+typedef enum traceEvent
+{
+	traceEventBoot = 0,
+	traceEventTrayState = 1,
+	traceEventDriveMounted = 2,
+	traceEventXbeProbed = 3,
+	traceEventDiscRejected = 4,
+	traceEventDriveStalled = 5,
+	traceEventLaunch = 6,
+	traceEventMediaClassified = 7,
+	traceEventThermalSample = 8,
+	traceEventThermalThrottle = 9,
+	traceEventCount = 10
+} traceEvent;
+
+class traceRing
+{
+public:
+
+	// The ring lives in persisted contiguous memory at a fixed physical
+	// address so it survives HalReturnToFirmware quick reboots. Records are
+	// a type byte followed by varint encoded time delta (ms) and value.
+	// init returns false and tracing stays off when the address is taken.
+	static bool init();
+	static void write(traceEvent event, uint32_t value);
+	static void dump();
+	static const char* getEventString(traceEvent event);
+};
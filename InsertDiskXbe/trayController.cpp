@@ -0,0 +1,192 @@
+#include "trayController.h"
+
+#define TRAY_EJECT_COMMAND_OPEN 0
+#define TRAY_EJECT_COMMAND_CLOSE 1
+
+namespace
+{
+	smcWriter mSmcWriter = HalWriteSMBusValue;
+
+	trayOperation mOperation = trayOperationNone;
+	trayCallback mCallback = NULL;
+	void* mUserData = NULL;
+	uint32_t mTimeout = 0;
+	uint32_t mStartTime = 0;
+	bool mStarted = false;
+
+	bool isClosedState(uint32_t trayState)
+	{
+		return trayState == SMC_TRAY_STATE_CLOSED || trayState == SMC_TRAY_STATE_ACTIVITY || trayState == SMC_TRAY_STATE_MEDIA_DETECT || trayState == SMC_TRAY_STATE_NO_MEDIA;
+	}
+
+	bool begin(trayOperation operation, uint32_t timeout, trayCallback callback, void* userData)
+	{
+		if (mOperation != trayOperationNone)
+		{
+			return false;
+		}
+		mOperation = operation;
+		mCallback = callback;
+		mUserData = userData;
+		mTimeout = timeout;
+		mStarted = false;
+		return true;
+	}
+
+	void complete(trayResult result)
+	{
+		trayOperation operation = mOperation;
+		trayCallback callback = mCallback;
+		void* userData = mUserData;
+
+		mOperation = trayOperationNone;
+		mCallback = NULL;
+		mUserData = NULL;
+
+		if (callback != NULL)
+		{
+			callback(operation, result, userData);
+		}
+	}
+
+	bool sendEjectCommand(uint32_t value)
+	{
+		return mSmcWriter(SMBDEV_PIC16L, PIC16L_CMD_EJECT, FALSE, value) >= 0;
+	}
+}
+
+void trayController::setSmcWriter(smcWriter writer)
+{
+	mSmcWriter = writer;
+}
+
+bool trayController::eject(uint32_t timeout, trayCallback callback, void* userData)
+{
+	return begin(trayOperationEject, timeout, callback, userData);
+}
+
+bool trayController::close(uint32_t timeout, trayCallback callback, void* userData)
+{
+	return begin(trayOperationClose, timeout, callback, userData);
+}
+
+bool trayController::waitForMedia(uint32_t timeout, trayCallback callback, void* userData)
+{
+	return begin(trayOperationWaitForMedia, timeout, callback, userData);
+}
+
+void trayController::cancel()
+{
+	if (mOperation != trayOperationNone)
+	{
+		complete(trayResultCancelled);
+	}
+}
+
+void trayController::update(uint32_t trayState, uint32_t now)
+{
+	if (mOperation == trayOperationNone)
+	{
+		return;
+	}
+
+	// Commands are only issued from update so callers never touch the SMBus
+	if (mStarted == false)
+	{
+		mStarted = true;
+		mStartTime = now;
+		if (mOperation == trayOperationEject && trayState != SMC_TRAY_STATE_OPEN && sendEjectCommand(TRAY_EJECT_COMMAND_OPEN) == false)
+		{
+			complete(trayResultFailed);
+			return;
+		}
+		if (mOperation == trayOperationClose && isClosedState(trayState) == false && sendEjectCommand(TRAY_EJECT_COMMAND_CLOSE) == false)
+		{
+			complete(trayResultFailed);
+			return;
+		}
+	}
+
+	if (mOperation == trayOperationEject)
+	{
+		if (trayState == SMC_TRAY_STATE_OPEN)
+		{
+			complete(trayResultCompleted);
+			return;
+		}
+	}
+	else if (mOperation == trayOperationClose)
+	{
+		if (isClosedState(trayState) == true)
+		{
+			complete(trayState == SMC_TRAY_STATE_NO_MEDIA ? trayResultNoMedia : trayResultCompleted);
+			return;
+		}
+	}
+	else if (mOperation == trayOperationWaitForMedia)
+	{
+		if (trayState == SMC_TRAY_STATE_MEDIA_DETECT)
+		{
+			complete(trayResultCompleted);
+			return;
+		}
+		if (trayState == SMC_TRAY_STATE_NO_MEDIA)
+		{
+			complete(trayResultNoMedia);
+			return;
+		}
+	}
+
+	if (mTimeout != 0 && now - mStartTime >= mTimeout)
+	{
+		complete(trayResultTimedOut);
+	}
+}
+
+bool trayController::isBusy()
+{
+	return mOperation != trayOperationNone;
+}
+
+trayOperation trayController::getOperation()
+{
+	return mOperation;
+}
+
+const char* trayController::getOperationString(trayOperation operation)
+{
+	if (operation == trayOperationEject)
+	{
+		return "Eject";
+	}
+	if (operation == trayOperationClose)
+	{
+		return "Close";
+	}
+	if (operation == trayOperationWaitForMedia)
+	{
+		return "Wait for media";
+	}
+	return "None";
+}
+
+const char* trayController::getResultString(trayResult result)
+{
+	if (result == trayResultCompleted)
+	{
+		return "Completed";
+	}
+	if (result == trayResultNoMedia)
+	{
+		return "No media";
+	}
+	if (result == trayResultTimedOut)
+	{
+		return "Timed out";
+	}
+	if (result == trayResultCancelled)
+	{
+		return "Cancelled";
+	}
+	return "Failed";
+}
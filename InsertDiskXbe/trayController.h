@@ -0,0 +1,42 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define TRAY_EJECT_TIMEOUT 5000
+#define TRAY_CLOSE_TIMEOUT 5000
+#define TRAY_MEDIA_TIMEOUT 30000
+
+typedef enum trayOperation
+{
+	trayOperationNone = 0,
+	trayOperationEject = 1,
+	trayOperationClose = 2,
+	trayOperationWaitForMedia = 3
+} trayOperation;
+
+typedef enum trayResult
+{
+	trayResultCompleted = 0,
+	trayResultNoMedia = 1,
+	trayResultTimedOut = 2,
+	trayResultCancelled = 3,
+	trayResultFailed = 4
+} trayResult;
+
+typedef void (*trayCallback)(trayOperation operation, trayResult result, void* userData);
+typedef NTSTATUS (WINAPI *smcWriter)(UCHAR address, UCHAR command, UCHAR writeWord, DWORD data);
+
+class trayController
+{
+public:
+	static void setSmcWriter(smcWriter writer);
+	static bool eject(uint32_t timeout, trayCallback callback, void* userData);
+	static bool close(uint32_t timeout, trayCallback callback, void* userData);
+	static bool waitForMedia(uint32_t timeout, trayCallback callback, void* userData);
+	static void cancel();
+	static void update(uint32_t trayState, uint32_t now);
+	static bool isBusy();
+	static trayOperation getOperation();
+	static const char* getOperationString(trayOperation operation);
+	static const char* getResultString(trayResult result);
+};
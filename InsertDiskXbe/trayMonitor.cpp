@@ -0,0 +1,172 @@
+#include "trayMonitor.h"
+#include "xboxinternals.h"
+
+#define TRAY_MAILBOX_SIZE 16
+#define TRAY_POLL_INTERVAL_MIN 16
+#define TRAY_POLL_INTERVAL_MAX 256
+#define TRAY_MAILBOX_TAKEN -1
+
+namespace
+{
+	trayStateReader mTrayStateReader = HalReadSMCTrayState;
+
+	HANDLE mThread = NULL;
+	volatile LONG mRunning = FALSE;
+	volatile LONG mTrayState = SMC_TRAY_STATE_RESET;
+
+	// Single producer (monitor thread) / single consumer (main loop) ring.
+	// Each side only ever writes its own index so no lock is needed.
+	volatile LONG mMailbox[TRAY_MAILBOX_SIZE];
+	volatile LONG mWriteIndex = 0;
+	volatile LONG mReadIndex = 0;
+
+	volatile LONG mPolls = 0;
+	volatile LONG mTransitions = 0;
+	volatile LONG mCoalescedEvents = 0;
+	volatile LONG mPollInterval = TRAY_POLL_INTERVAL_MIN;
+	volatile LONG mPollScale = 1;
+	volatile LONG mLastTransitionTime = 0;
+
+	bool isStableState(uint32_t trayState)
+	{
+		return trayState == SMC_TRAY_STATE_OPEN || trayState == SMC_TRAY_STATE_NO_MEDIA || trayState == SMC_TRAY_STATE_MEDIA_DETECT || trayState == SMC_TRAY_STATE_CLOSED;
+	}
+
+	uint32_t readTrayState()
+	{
+		ULONG trayState = 0;
+		if (mTrayStateReader(&trayState, NULL) < 0)
+		{
+			return (uint32_t)mTrayState;
+		}
+		InterlockedIncrement(&mPolls);
+		return trayState;
+	}
+
+	// A full mailbox folds the new state into its newest entry, so the last
+	// state the consumer reads is always the current one. The consumer
+	// takes entries by swapping in TRAY_MAILBOX_TAKEN, if it took the
+	// newest entry meanwhile there is room again on the next pass.
+	void publish(uint32_t trayState)
+	{
+		InterlockedExchange(&mTrayState, trayState);
+		InterlockedExchange(&mLastTransitionTime, GetTickCount());
+		InterlockedIncrement(&mTransitions);
+
+		while (true)
+		{
+			LONG writeIndex = mWriteIndex;
+			LONG nextIndex = (writeIndex + 1) % TRAY_MAILBOX_SIZE;
+			if (nextIndex != mReadIndex)
+			{
+				mMailbox[writeIndex] = trayState;
+				InterlockedExchange(&mWriteIndex, nextIndex);
+				return;
+			}
+
+			LONG lastIndex = (writeIndex + TRAY_MAILBOX_SIZE - 1) % TRAY_MAILBOX_SIZE;
+			LONG lastState = mMailbox[lastIndex];
+			if (lastState != TRAY_MAILBOX_TAKEN && InterlockedCompareExchange(&mMailbox[lastIndex], trayState, lastState) == lastState)
+			{
+				InterlockedIncrement(&mCoalescedEvents);
+				return;
+			}
+		}
+	}
+
+	void delay(uint32_t milliseconds)
+	{
+		LARGE_INTEGER interval;
+		interval.QuadPart = -((LONGLONG)milliseconds * 10000);
+		KeDelayExecutionThread(1, FALSE, &interval);
+	}
+
+	DWORD WINAPI monitorThread(LPVOID param)
+	{
+		uint32_t pollInterval = TRAY_POLL_INTERVAL_MIN;
+		while (mRunning == TRUE)
+		{
+			delay(pollInterval * mPollScale);
+
+			uint32_t trayState = readTrayState();
+			if (trayState != (uint32_t)mTrayState)
+			{
+				publish(trayState);
+				pollInterval = TRAY_POLL_INTERVAL_MIN;
+			}
+			else if (isStableState(trayState) == true && pollInterval < TRAY_POLL_INTERVAL_MAX)
+			{
+				pollInterval = pollInterval * 2;
+			}
+			InterlockedExchange(&mPollInterval, pollInterval * mPollScale);
+		}
+		return 0;
+	}
+}
+
+void trayMonitor::setTrayStateReader(trayStateReader reader)
+{
+	mTrayStateReader = reader;
+}
+
+void trayMonitor::setPollScale(uint32_t scale)
+{
+	InterlockedExchange(&mPollScale, scale == 0 ? 1 : scale);
+}
+
+bool trayMonitor::start()
+{
+	if (mThread != NULL)
+	{
+		return true;
+	}
+
+	publish(readTrayState());
+
+	mRunning = TRUE;
+	mThread = CreateThread(NULL, 0, monitorThread, NULL, 0, NULL);
+	if (mThread == NULL)
+	{
+		mRunning = FALSE;
+		return false;
+	}
+	return true;
+}
+
+void trayMonitor::stop()
+{
+	if (mThread == NULL)
+	{
+		return;
+	}
+	InterlockedExchange(&mRunning, FALSE);
+	WaitForSingleObject(mThread, INFINITE);
+	CloseHandle(mThread);
+	mThread = NULL;
+}
+
+bool trayMonitor::pollEvent(uint32_t& trayState)
+{
+	LONG readIndex = mReadIndex;
+	if (readIndex == mWriteIndex)
+	{
+		return false;
+	}
+	trayState = (uint32_t)InterlockedExchange(&mMailbox[readIndex], TRAY_MAILBOX_TAKEN);
+	InterlockedExchange(&mReadIndex, (readIndex + 1) % TRAY_MAILBOX_SIZE);
+	return true;
+}
+
+uint32_t trayMonitor::getTrayState()
+{
+	return (uint32_t)mTrayState;
+}
+
+void trayMonitor::getStats(trayStats& stats)
+{
+	stats.polls = (uint32_t)mPolls;
+	stats.transitions = (uint32_t)mTransitions;
+	stats.coalescedEvents = (uint32_t)mCoalescedEvents;
+	stats.pollInterval = (uint32_t)mPollInterval;
+	stats.lastTransitionTime = (uint32_t)mLastTransitionTime;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+typedef NTSTATUS (WINAPI *trayStateReader)(ULONG* trayState, ULONG* ejectCount);
+
+class trayMonitor
+{
+public:
+
+	typedef struct trayStats
+	{
+		uint32_t polls;
+		uint32_t transitions;
+		uint32_t coalescedEvents;
+		uint32_t pollInterval;
+		uint32_t lastTransitionTime;
+	} trayStats;
+
+	static void setTrayStateReader(trayStateReader reader);
+	static void setPollScale(uint32_t scale);
+	static bool start();
+	static void stop();
+	static bool pollEvent(uint32_t& trayState);
+	static uint32_t getTrayState();
+	static void getStats(trayStats& stats);
+};
@@ -47,3 +47,22 @@ uint32_t utils::roundUpToNextPowerOf2(uint32_t value)
 	value++;
 	return value;
 }
+
+uint64_t utils::getPerformanceCounter()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)counter.QuadPart;
+}
+
+double utils::getElapsedMilliseconds(uint64_t start, uint64_t end)
+{
+	static double frequency = 0;
+	if (frequency == 0)
+	{
+		LARGE_INTEGER counterFrequency;
+		QueryPerformanceFrequency(&counterFrequency);
+		frequency = (double)counterFrequency.QuadPart / 1000.0;
+	}
+	return (double)(int64_t)(end - start) / frequency;
+}
@@ -38,4 +38,6 @@ public:
 	static void* mallocWithTerminator(uint32_t size);
 	static void* mallocCopyWithTerminator(void* source, uint32_t size, uint32_t copySize);
 	static uint32_t roundUpToNextPowerOf2(uint32_t value);
+	static uint64_t getPerformanceCounter();
+	static double getElapsedMilliseconds(uint64_t start, uint64_t end);
 };
@@ -0,0 +1,405 @@
+#include "verifyStation.h"
+#include "hashUtility.h"
+#include "fileSystem.h"
+#include "driveManager.h"
+#include "stringUtility.h"
+#include "pointerMap.h"
+#include "sectionLoader.h"
+#include "utils.h"
+
+#define VERIFY_DISC_ROOT "D:"
+#define VERIFY_READ_SIZE 0x40000
+
+namespace
+{
+	typedef struct verifyFile
+	{
+		char* relativePath;
+		uint32_t size;
+	} verifyFile;
+
+	typedef struct manifestEntry
+	{
+		hashUtility::hashResult result;
+		bool seen;
+	} manifestEntry;
+
+	pointerMap* mManifest = NULL;
+
+	volatile LONG mState = verifyStateIdle;
+	volatile LONG mCancelRequested = 0;
+	volatile LONG mFileCount = 0;
+	volatile LONG mFilesDone = 0;
+	volatile LONG mTotalKilobytes = 0;
+	volatile LONG mKilobytesDone = 0;
+	volatile LONG mElapsedMilliseconds = 0;
+	uint32_t mStartTime = 0;
+	uint32_t mMatched = 0;
+	uint32_t mMismatched = 0;
+	uint32_t mUnlisted = 0;
+	uint32_t mMissing = 0;
+
+	// Manifest keys are lower case so lookups ignore the case on the disc
+	char* createKey(const char* relativePath)
+	{
+		return stringUtility::lowerCase(relativePath);
+	}
+
+	const char* skipField(const char* value)
+	{
+		while (*value == ' ' || *value == '\t')
+		{
+			value++;
+		}
+		while (*value != 0 && *value != ' ' && *value != '\t')
+		{
+			value++;
+		}
+		return value;
+	}
+
+	void parseManifestLine(char* line)
+	{
+		size_t length = strlen(line);
+		while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' '))
+		{
+			line[--length] = 0;
+		}
+		if (length == 0 || line[0] == '#')
+		{
+			return;
+		}
+
+		manifestEntry* entry = new manifestEntry();
+		entry->seen = false;
+		const char* path = skipField(skipField(skipField(line)));
+		while (*path == ' ' || *path == '\t')
+		{
+			path++;
+		}
+		if (hashUtility::parseResult(line, entry->result) == false || *path == 0)
+		{
+			utils::debugPrint("Ignoring manifest line: %s\n", line);
+			delete(entry);
+			return;
+		}
+
+		char* key = createKey(path);
+		mManifest->add(key, entry);
+		free(key);
+	}
+
+	void collectFiles(const char* path, const char* relativePath, pointerVector* files, uint64_t& totalBytes)
+	{
+		pointerVector* entries = fileSystem::fileGetDirectoryEntries(path);
+		for (uint32_t i = 0; i < entries->count(); i++)
+		{
+			fileSystem::FileInfoDetail* entry = (fileSystem::FileInfoDetail*)entries->get(i);
+			char* fileName = fileSystem::getFileName(entry->path);
+			char* entryRelativePath = strlen(relativePath) == 0 ? strdup(fileName) : stringUtility::formatString("%s\\%s", relativePath, fileName);
+			free(fileName);
+
+			if (entry->isDirectory == true)
+			{
+				collectFiles(entry->path, entryRelativePath, files, totalBytes);
+				free(entryRelativePath);
+				continue;
+			}
+
+			verifyFile* file = (verifyFile*)malloc(sizeof(verifyFile));
+			file->relativePath = entryRelativePath;
+			file->size = entry->size;
+			files->add(file);
+			totalBytes += entry->size;
+		}
+		delete(entries);
+	}
+
+	bool queueRead(HANDLE file, uint8_t* buffer, OVERLAPPED& overlapped, uint32_t offset)
+	{
+		overlapped.Offset = offset;
+		overlapped.OffsetHigh = 0;
+		ResetEvent(overlapped.hEvent);
+		if (ReadFile(file, buffer, VERIFY_READ_SIZE, NULL, &overlapped) == TRUE)
+		{
+			return true;
+		}
+		return GetLastError() == ERROR_IO_PENDING;
+	}
+
+	// Reads are unbuffered and double buffered, the next read is queued
+	// before the current buffer is hashed so the drive never waits on the CPU.
+	bool hashFile(const verifyFile* file, uint8_t** buffers, uint64_t& bytesDone, hashUtility::hashResult& result)
+	{
+		char* path = stringUtility::formatString("%s\\%s", VERIFY_DISC_ROOT, file->relativePath);
+		HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		free(path);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		OVERLAPPED overlapped[2];
+		memset(overlapped, 0, sizeof(overlapped));
+		overlapped[0].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		overlapped[1].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+		hashUtility::hashContext context;
+		hashUtility::init(context);
+
+		uint32_t offset = 0;
+		uint32_t current = 0;
+		bool pending = file->size > 0 && queueRead(fileHandle, buffers[current], overlapped[current], offset);
+		while (pending == true)
+		{
+			DWORD bytesRead = 0;
+			if (GetOverlappedResult(fileHandle, &overlapped[current], &bytesRead, TRUE) == FALSE || bytesRead == 0)
+			{
+				break;
+			}
+			offset += bytesRead;
+
+			uint32_t next = current ^ 1;
+			pending = bytesRead == VERIFY_READ_SIZE && offset < file->size && mCancelRequested == 0 && queueRead(fileHandle, buffers[next], overlapped[next], offset);
+			hashUtility::update(context, buffers[current], bytesRead);
+
+			bytesDone += bytesRead;
+			InterlockedExchange(&mKilobytesDone, (LONG)(bytesDone >> 10));
+			current = next;
+		}
+
+		CloseHandle(overlapped[0].hEvent);
+		CloseHandle(overlapped[1].hEvent);
+		CloseHandle(fileHandle);
+
+		hashUtility::final(context, result);
+		return offset == file->size;
+	}
+
+	void verifyFiles(pointerVector* files, uint8_t** buffers)
+	{
+		pointerVector* keys = mManifest->keys();
+		for (uint32_t i = 0; i < keys->count(); i++)
+		{
+			manifestEntry* entry = (manifestEntry*)mManifest->get((const char*)keys->get(i));
+			entry->seen = false;
+		}
+
+		uint32_t resultsHandle = 0;
+		bool resultsOpen = fileSystem::fileOpen(VERIFY_RESULTS_PATH, fileSystem::FileModeWrite, resultsHandle);
+
+		uint64_t bytesDone = 0;
+		for (uint32_t i = 0; i < files->count() && mCancelRequested == 0; i++)
+		{
+			verifyFile* file = (verifyFile*)files->get(i);
+
+			hashUtility::hashResult result;
+			bool readOk = hashFile(file, buffers, bytesDone, result);
+
+			char* key = createKey(file->relativePath);
+			manifestEntry* expected = (manifestEntry*)mManifest->get(key);
+			free(key);
+			if (expected == NULL)
+			{
+				utils::debugPrint("Unlisted: %s\n", file->relativePath);
+				mUnlisted++;
+			}
+			else if (readOk == true && hashUtility::equals(expected->result, result) == true)
+			{
+				mMatched++;
+			}
+			else
+			{
+				utils::debugPrint("%s: %s\n", readOk == true ? "Mismatch" : "Read failed", file->relativePath);
+				mMismatched++;
+			}
+			if (expected != NULL)
+			{
+				expected->seen = true;
+			}
+
+			if (resultsOpen == true && readOk == true)
+			{
+				char* hashText = hashUtility::formatResult(result);
+				char* line = stringUtility::formatString("%s %s\r\n", hashText, file->relativePath);
+				uint32_t bytesWritten = 0;
+				fileSystem::fileWrite(resultsHandle, line, (uint32_t)strlen(line), bytesWritten);
+				free(line);
+				free(hashText);
+			}
+			InterlockedIncrement(&mFilesDone);
+		}
+
+		if (mCancelRequested == 0)
+		{
+			for (uint32_t i = 0; i < keys->count(); i++)
+			{
+				const char* key = (const char*)keys->get(i);
+				manifestEntry* entry = (manifestEntry*)mManifest->get(key);
+				if (entry->seen == false)
+				{
+					utils::debugPrint("Missing: %s\n", key);
+					mMissing++;
+				}
+			}
+		}
+		delete(keys);
+
+		if (resultsOpen == true)
+		{
+			fileSystem::fileClose(resultsHandle);
+		}
+	}
+
+	DWORD WINAPI verifyThread(LPVOID param)
+	{
+		pointerVector* files = new pointerVector(false);
+		uint64_t totalBytes = 0;
+		collectFiles(VERIFY_DISC_ROOT, "", files, totalBytes);
+		InterlockedExchange(&mTotalKilobytes, (LONG)(totalBytes >> 10));
+		InterlockedExchange(&mFileCount, (LONG)files->count());
+
+		uint8_t* buffers[2];
+		buffers[0] = (uint8_t*)VirtualAlloc(NULL, VERIFY_READ_SIZE * 2, MEM_COMMIT, PAGE_READWRITE);
+		buffers[1] = buffers[0] + VERIFY_READ_SIZE;
+		if (buffers[0] != NULL)
+		{
+			verifyFiles(files, buffers);
+			VirtualFree(buffers[0], 0, MEM_RELEASE);
+		}
+
+		for (uint32_t i = 0; i < files->count(); i++)
+		{
+			verifyFile* file = (verifyFile*)files->get(i);
+			free(file->relativePath);
+		}
+		delete(files);
+
+		uint32_t elapsed = GetTickCount() - mStartTime;
+		InterlockedExchange(&mElapsedMilliseconds, (LONG)elapsed);
+		utils::debugPrint("Verify %s after %ums: %u matched, %u mismatched, %u unlisted, %u missing\n", mCancelRequested == 0 ? "completed" : "cancelled", elapsed, mMatched, mMismatched, mUnlisted, mMissing);
+		InterlockedExchange(&mState, mCancelRequested == 0 ? verifyStateCompleted : verifyStateCancelled);
+		return 0;
+	}
+}
+
+bool verifyStation::loadManifest()
+{
+	if (mManifest != NULL)
+	{
+		return isEnabled();
+	}
+	mManifest = new pointerMap(true);
+
+	driveManager::mountDrive("E");
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(VERIFY_MANIFEST_PATH, fileSystem::FileModeRead, fileHandle) == false)
+	{
+		return false;
+	}
+
+	// Hashing stays resident for as long as verify mode is enabled
+	if (sectionLoader::load(sectionGroupHash) == false)
+	{
+		fileSystem::fileClose(fileHandle);
+		return false;
+	}
+
+	uint32_t size = 0;
+	fileSystem::fileSize(fileHandle, size);
+	char* manifest = (char*)malloc(size + 1);
+	uint32_t bytesRead = 0;
+	fileSystem::fileRead(fileHandle, manifest, size, bytesRead);
+	fileSystem::fileClose(fileHandle);
+	manifest[bytesRead] = 0;
+
+	char* line = manifest;
+	while (line != NULL && *line != 0)
+	{
+		char* lineEnd = strchr(line, '\n');
+		if (lineEnd != NULL)
+		{
+			*lineEnd = 0;
+		}
+		parseManifestLine(line);
+		line = lineEnd == NULL ? NULL : lineEnd + 1;
+	}
+	free(manifest);
+
+	utils::debugPrint("Verify manifest: %u entries\n", mManifest->count());
+	if (isEnabled() == false)
+	{
+		sectionLoader::unload(sectionGroupHash);
+	}
+	return isEnabled();
+}
+
+bool verifyStation::isEnabled()
+{
+	return mManifest != NULL && mManifest->count() > 0;
+}
+
+bool verifyStation::start()
+{
+	if (isEnabled() == false || mState != verifyStateIdle)
+	{
+		return false;
+	}
+
+	mCancelRequested = 0;
+	mFileCount = 0;
+	mFilesDone = 0;
+	mTotalKilobytes = 0;
+	mKilobytesDone = 0;
+	mElapsedMilliseconds = 0;
+	mMatched = 0;
+	mMismatched = 0;
+	mUnlisted = 0;
+	mMissing = 0;
+	mStartTime = GetTickCount();
+	mState = verifyStateRunning;
+
+	HANDLE thread = CreateThread(NULL, 0, verifyThread, NULL, 0, NULL);
+	if (thread == NULL)
+	{
+		mState = verifyStateIdle;
+		return false;
+	}
+	CloseHandle(thread);
+	return true;
+}
+
+void verifyStation::cancel()
+{
+	InterlockedExchange(&mCancelRequested, 1);
+}
+
+void verifyStation::reset()
+{
+	if (mState == verifyStateCompleted || mState == verifyStateCancelled)
+	{
+		mState = verifyStateIdle;
+	}
+}
+
+verifyState verifyStation::getState()
+{
+	return (verifyState)mState;
+}
+
+void verifyStation::getProgress(verifyProgress& progress)
+{
+	progress.fileCount = mFileCount;
+	progress.filesDone = mFilesDone;
+	progress.totalKilobytes = mTotalKilobytes;
+	progress.kilobytesDone = mKilobytesDone;
+	progress.elapsedMilliseconds = mState == verifyStateRunning ? GetTickCount() - mStartTime : mElapsedMilliseconds;
+
+	// Result counters are only final once the worker has finished
+	bool finished = mState == verifyStateCompleted || mState == verifyStateCancelled;
+	progress.matched = finished == true ? mMatched : 0;
+	progress.mismatched = finished == true ? mMismatched : 0;
+	progress.unlisted = finished == true ? mUnlisted : 0;
+	progress.missing = finished == true ? mMissing : 0;
+}
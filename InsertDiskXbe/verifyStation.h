@@ -0,0 +1,42 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define VERIFY_MANIFEST_PATH "E:\\InsertDiskXbe\\verify.txt"
+#define VERIFY_RESULTS_PATH "E:\\InsertDiskXbe\\verifyResults.txt"
+
+typedef enum verifyState
+{
+	verifyStateIdle = 0,
+	verifyStateRunning = 1,
+	verifyStateCompleted = 2,
+	verifyStateCancelled = 3
+} verifyState;
+
+class verifyStation
+{
+public:
+
+	typedef struct verifyProgress
+	{
+		uint32_t fileCount;
+		uint32_t filesDone;
+		uint32_t totalKilobytes;
+		uint32_t kilobytesDone;
+		uint32_t elapsedMilliseconds;
+		uint32_t matched;
+		uint32_t mismatched;
+		uint32_t unlisted;
+		uint32_t missing;
+	} verifyProgress;
+
+	// Manifest lines are "crc32 md5 sha1 path" with the path relative to the
+	// disc root, the same format the results file is written in.
+	static bool loadManifest();
+	static bool isEnabled();
+	static bool start();
+	static void cancel();
+	static void reset();
+	static verifyState getState();
+	static void getProgress(verifyProgress& progress);
+};
@@ -0,0 +1,107 @@
+#include "vertexRing.h"
+#include "context.h"
+#include "deviceState.h"
+#include "commandList.h"
+#include "utils.h"
+
+namespace
+{
+	D3DVertexBuffer* mVertexBuffer = NULL;
+	uint8_t* mData = NULL;
+	uint32_t mOffset = 0;
+	uint32_t mRegion = 0;
+	DWORD mRegionFences[VERTEX_RING_REGIONS];
+	vertexRing::ringStats mStats = { 0 };
+
+	// Fences the region being left so its draws can be waited on, then
+	// waits out the draws still reading the region being entered. Draws
+	// still in the command list are submitted first so the fence is
+	// inserted after them.
+	void enterRegion(uint32_t region)
+	{
+		commandList::submit();
+		LPDIRECT3DDEVICE8 device = context::getD3dDevice();
+		mRegionFences[mRegion] = device->InsertFence();
+		if (mRegionFences[region] != 0 && device->IsFencePending(mRegionFences[region]) == TRUE)
+		{
+			device->BlockOnFence(mRegionFences[region]);
+			mStats.fenceWaits++;
+		}
+		mRegionFences[region] = 0;
+		mRegion = region;
+	}
+}
+
+bool vertexRing::init()
+{
+	if (mVertexBuffer != NULL)
+	{
+		return true;
+	}
+
+	if (FAILED(context::getD3dDevice()->CreateVertexBuffer(VERTEX_RING_SIZE, D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &mVertexBuffer)))
+	{
+		utils::debugPrint("Failed to create vertex ring\n");
+		return false;
+	}
+
+	// Memory is shared with the GPU, the buffer stays locked for good and
+	// the region fences take the place of the lock's own synchronization
+	BYTE* data = NULL;
+	if (FAILED(mVertexBuffer->Lock(0, 0, &data, D3DLOCK_NOOVERWRITE)))
+	{
+		mVertexBuffer->Release();
+		mVertexBuffer = NULL;
+		return false;
+	}
+	mData = data;
+	memset(mRegionFences, 0, sizeof(mRegionFences));
+	return true;
+}
+
+void* vertexRing::allocate(uint32_t vertexCount, uint32_t stride, uint32_t& startVertex)
+{
+	uint32_t size = vertexCount * stride;
+	if (mData == NULL || size == 0 || size > VERTEX_RING_REGION_SIZE - stride)
+	{
+		return NULL;
+	}
+
+	// Start on a whole vertex so the offset maps to a vertex index
+	uint32_t offset = ((mOffset + stride - 1) / stride) * stride;
+
+	// An allocation never spans two regions, entering the second would
+	// fence the first before the draw reading it had been recorded
+	uint32_t lastRegion = (offset + size - 1) / VERTEX_RING_REGION_SIZE;
+	if (lastRegion != offset / VERTEX_RING_REGION_SIZE)
+	{
+		offset = ((lastRegion * VERTEX_RING_REGION_SIZE + stride - 1) / stride) * stride;
+	}
+	if (offset + size > VERTEX_RING_SIZE)
+	{
+		offset = 0;
+		mStats.wraps++;
+	}
+
+	uint32_t region = offset / VERTEX_RING_REGION_SIZE;
+	if (region != mRegion)
+	{
+		enterRegion(region);
+	}
+
+	mOffset = offset + size;
+	mStats.allocations++;
+	mStats.bytes += size;
+	startVertex = offset / stride;
+	return mData + offset;
+}
+
+void vertexRing::bind(uint32_t stride)
+{
+	deviceState::setStreamSource(0, mVertexBuffer, stride);
+}
+
+void vertexRing::getStats(ringStats& stats)
+{
+	stats = mStats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define VERTEX_RING_SIZE (1024 * 1024)
+#define VERTEX_RING_REGIONS 4
+#define VERTEX_RING_REGION_SIZE (VERTEX_RING_SIZE / VERTEX_RING_REGIONS)
+
+class vertexRing
+{
+public:
+
+	typedef struct ringStats
+	{
+		uint32_t allocations;
+		uint32_t bytes;
+		uint32_t wraps;
+		uint32_t fenceWaits;
+	} ringStats;
+
+	// allocate returns memory inside the vertex buffer for the caller to
+	// write vertexCount vertices into, startVertex is the first vertex for
+	// DrawPrimitive or the base vertex of an indexed draw after bind. The
+	// ring is split into regions, a region is fenced when writing leaves it
+	// and waited on before it is reused, so vertices are never overwritten
+	// while the GPU may still read them.
+	// An allocation stays inside one region, so a single allocation may not
+	// exceed VERTEX_RING_REGION_SIZE less one vertex.
+	static bool init();
+	static void* allocate(uint32_t vertexCount, uint32_t stride, uint32_t& startVertex);
+	static void bind(uint32_t stride);
+	static void getStats(ringStats& stats);
+};
@@ -0,0 +1,20 @@
+#include "xboxinternals.h"
+
+// CRT headers come first so their inline functions stay in the preloaded
+// image, only the stb code below moves to the on demand section.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <malloc.h>
+#include <limits.h>
+
+// Loaded through sectionLoader, sectionGroupVorbis
+#pragma code_seg("VORB")
+#pragma const_seg("VORB_RD")
+
+#include "stb_vorbis.cpp"
+
+#pragma const_seg()
+#pragma code_seg()
@@ -0,0 +1,268 @@
+#include "xbeHeader.h"
+#include "fileSystem.h"
+
+#include <string.h>
+
+#define XBE_PAGE_SIZE 0x1000
+
+namespace
+{
+	uint32_t readUInt32(const uint8_t* buffer, uint32_t offset)
+	{
+		return (uint32_t)buffer[offset] | ((uint32_t)buffer[offset + 1] << 8) | ((uint32_t)buffer[offset + 2] << 16) | ((uint32_t)buffer[offset + 3] << 24);
+	}
+
+	bool rangeInHeaders(uint32_t address, uint32_t size, uint32_t baseAddress, uint32_t sizeOfHeaders)
+	{
+		if (address < baseAddress)
+		{
+			return false;
+		}
+		uint32_t offset = address - baseAddress;
+		return offset <= sizeOfHeaders && size <= sizeOfHeaders - offset;
+	}
+
+	void parseCertificate(const uint8_t* certificate, xbeHeader::xbeInfo& info)
+	{
+		info.titleId = readUInt32(certificate, 0x008);
+		info.allowedMediaTypes = readUInt32(certificate, 0x09C);
+		info.gameRegion = readUInt32(certificate, 0x0A0);
+		info.diskNumber = readUInt32(certificate, 0x0A8);
+		info.version = readUInt32(certificate, 0x0AC);
+
+		// Title name is 40 UTF-16 characters, keep the ASCII range only
+		for (uint32_t i = 0; i < 40; i++)
+		{
+			uint32_t character = certificate[0x00C + (i * 2)] | (certificate[0x00C + (i * 2) + 1] << 8);
+			if (character == 0)
+			{
+				break;
+			}
+			info.titleName[i] = character < 0x80 ? (char)character : '?';
+		}
+	}
+}
+
+xbeHeader::xbeResult xbeHeader::parse(const uint8_t* buffer, uint32_t length, xbeInfo& info)
+{
+	memset(&info, 0, sizeof(xbeInfo));
+
+	if (length < XBE_IMAGE_HEADER_SIZE)
+	{
+		return xbeResultBadHeaderSize;
+	}
+
+	if (readUInt32(buffer, 0x000) != XBE_MAGIC)
+	{
+		return xbeResultBadMagic;
+	}
+
+	info.baseAddress = readUInt32(buffer, 0x104);
+	info.sizeOfHeaders = readUInt32(buffer, 0x108);
+	info.sizeOfImage = readUInt32(buffer, 0x10C);
+	info.timeDate = readUInt32(buffer, 0x114);
+	if (info.baseAddress != XBE_BASE_ADDRESS)
+	{
+		return xbeResultBadBaseAddress;
+	}
+	if (info.sizeOfHeaders < XBE_IMAGE_HEADER_SIZE || info.sizeOfHeaders > XBE_MAX_HEADER_SIZE || info.sizeOfHeaders > length || info.sizeOfImage < info.sizeOfHeaders)
+	{
+		return xbeResultBadHeaderSize;
+	}
+
+	uint32_t sectionCount = readUInt32(buffer, 0x11C);
+	uint32_t sectionHeadersAddress = readUInt32(buffer, 0x120);
+	if (sectionCount == 0 || sectionCount > XBE_MAX_SECTIONS || rangeInHeaders(sectionHeadersAddress, sectionCount * XBE_SECTION_HEADER_SIZE, info.baseAddress, info.sizeOfHeaders) == false)
+	{
+		return xbeResultBadSectionTable;
+	}
+	info.sectionCount = sectionCount;
+
+	uint32_t imageEnd = info.baseAddress + info.sizeOfImage;
+	const uint8_t* sectionHeader = buffer + (sectionHeadersAddress - info.baseAddress);
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		uint32_t flags = readUInt32(sectionHeader, 0x00);
+		uint32_t virtualAddress = readUInt32(sectionHeader, 0x04);
+		uint32_t virtualSize = readUInt32(sectionHeader, 0x08);
+		uint32_t sectionNameAddress = readUInt32(sectionHeader, 0x14);
+		if (virtualAddress < info.baseAddress || virtualAddress > imageEnd || virtualSize > imageEnd - virtualAddress)
+		{
+			return xbeResultBadSectionTable;
+		}
+		if (rangeInHeaders(sectionNameAddress, 1, info.baseAddress, info.sizeOfHeaders) == false)
+		{
+			return xbeResultBadSectionTable;
+		}
+		if ((flags & XBE_SECTION_FLAG_PRELOAD) != 0)
+		{
+			info.preloadSize += virtualSize;
+		}
+		else
+		{
+			info.deferredSize += virtualSize;
+		}
+		sectionHeader += XBE_SECTION_HEADER_SIZE;
+	}
+
+	uint32_t certificateAddress = readUInt32(buffer, 0x118);
+	if (rangeInHeaders(certificateAddress, XBE_CERTIFICATE_MIN_SIZE, info.baseAddress, info.sizeOfHeaders) == false)
+	{
+		return xbeResultBadCertificate;
+	}
+
+	const uint8_t* certificate = buffer + (certificateAddress - info.baseAddress);
+	uint32_t certificateSize = readUInt32(certificate, 0x000);
+	if (certificateSize < XBE_CERTIFICATE_MIN_SIZE || rangeInHeaders(certificateAddress, certificateSize, info.baseAddress, info.sizeOfHeaders) == false)
+	{
+		return xbeResultBadCertificate;
+	}
+
+	parseCertificate(certificate, info);
+	return xbeResultOk;
+}
+
+xbeHeader::xbeResult xbeHeader::read(const char* path, xbeInfo& info)
+{
+	memset(&info, 0, sizeof(xbeInfo));
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(path, fileSystem::FileModeRead, fileHandle) == false)
+	{
+		return xbeResultReadFailed;
+	}
+
+	uint8_t* buffer = (uint8_t*)malloc(XBE_PAGE_SIZE);
+	uint32_t bytesRead = 0;
+	if (fileSystem::fileRead(fileHandle, (char*)buffer, XBE_PAGE_SIZE, bytesRead) == false || bytesRead < XBE_IMAGE_HEADER_SIZE)
+	{
+		free(buffer);
+		fileSystem::fileClose(fileHandle);
+		return xbeResultReadFailed;
+	}
+
+	// Only pull in further pages when the headers do not fit in the first one
+	uint32_t sizeOfHeaders = readUInt32(buffer, 0x108);
+	if (readUInt32(buffer, 0x000) == XBE_MAGIC && sizeOfHeaders > bytesRead && sizeOfHeaders <= XBE_MAX_HEADER_SIZE)
+	{
+		uint8_t* largerBuffer = (uint8_t*)realloc(buffer, sizeOfHeaders);
+		if (largerBuffer == NULL)
+		{
+			free(buffer);
+			fileSystem::fileClose(fileHandle);
+			return xbeResultReadFailed;
+		}
+		buffer = largerBuffer;
+
+		while (bytesRead < sizeOfHeaders)
+		{
+			uint32_t chunkSize = min(sizeOfHeaders - bytesRead, XBE_PAGE_SIZE);
+			uint32_t chunkRead = 0;
+			if (fileSystem::fileRead(fileHandle, (char*)buffer + bytesRead, chunkSize, chunkRead) == false || chunkRead == 0)
+			{
+				break;
+			}
+			bytesRead += chunkRead;
+		}
+	}
+	fileSystem::fileClose(fileHandle);
+
+	xbeResult result = parse(buffer, bytesRead, info);
+	free(buffer);
+	return result;
+}
+
+xbeHeader::xbeResult xbeHeader::readIdentity(const char* path, xbeInfo& info)
+{
+	memset(&info, 0, sizeof(xbeInfo));
+
+	uint32_t fileHandle;
+	if (fileSystem::fileOpen(path, fileSystem::FileModeRead, fileHandle) == false)
+	{
+		return xbeResultReadFailed;
+	}
+
+	uint8_t buffer[XBE_PAGE_SIZE];
+	uint32_t bytesRead = 0;
+	bool readResult = fileSystem::fileRead(fileHandle, (char*)buffer, XBE_PAGE_SIZE, bytesRead);
+	fileSystem::fileClose(fileHandle);
+	if (readResult == false || bytesRead < XBE_IMAGE_HEADER_SIZE)
+	{
+		return xbeResultReadFailed;
+	}
+
+	if (readUInt32(buffer, 0x000) != XBE_MAGIC)
+	{
+		return xbeResultBadMagic;
+	}
+
+	info.baseAddress = readUInt32(buffer, 0x104);
+	info.timeDate = readUInt32(buffer, 0x114);
+	if (info.baseAddress != XBE_BASE_ADDRESS)
+	{
+		return xbeResultBadBaseAddress;
+	}
+
+	uint32_t certificateAddress = readUInt32(buffer, 0x118);
+	if (rangeInHeaders(certificateAddress, XBE_CERTIFICATE_MIN_SIZE, info.baseAddress, bytesRead) == false)
+	{
+		return xbeResultBadCertificate;
+	}
+
+	parseCertificate(buffer + (certificateAddress - info.baseAddress), info);
+	return xbeResultOk;
+}
+
+xbeHeader::xbeResult xbeHeader::validate(const xbeInfo& info, uint32_t gameRegion)
+{
+	if ((info.allowedMediaTypes & XBE_MEDIA_TYPE_DISC_MASK) == 0)
+	{
+		return xbeResultBadMediaType;
+	}
+	if ((info.gameRegion & XBE_GAME_REGION_MANUFACTURING) == 0 && (info.gameRegion & gameRegion) == 0)
+	{
+		return xbeResultBadRegion;
+	}
+	return xbeResultOk;
+}
+
+const char* xbeHeader::getResultString(xbeResult result)
+{
+	if (result == xbeResultOk)
+	{
+		return "OK";
+	}
+	if (result == xbeResultReadFailed)
+	{
+		return "Unable to read default.xbe";
+	}
+	if (result == xbeResultBadMagic)
+	{
+		return "Not an XBE";
+	}
+	if (result == xbeResultBadBaseAddress)
+	{
+		return "Bad base address";
+	}
+	if (result == xbeResultBadHeaderSize)
+	{
+		return "Bad header size";
+	}
+	if (result == xbeResultBadSectionTable)
+	{
+		return "Bad section table";
+	}
+	if (result == xbeResultBadCertificate)
+	{
+		return "Bad certificate";
+	}
+	if (result == xbeResultBadMediaType)
+	{
+		return "Media type not allowed";
+	}
+	if (result == xbeResultBadRegion)
+	{
+		return "Wrong game region";
+	}
+	return "Unknown error";
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define XBE_MAGIC 0x48454258
+#define XBE_BASE_ADDRESS 0x00010000
+#define XBE_IMAGE_HEADER_SIZE 0x178
+#define XBE_SECTION_HEADER_SIZE 0x38
+#define XBE_CERTIFICATE_MIN_SIZE 0x1D0
+#define XBE_MAX_HEADER_SIZE 0x10000
+#define XBE_MAX_SECTIONS 256
+
+#define XBE_SECTION_FLAG_PRELOAD 0x00000002
+
+#define XBE_MEDIA_TYPE_HARD_DISK 0x00000001
+#define XBE_MEDIA_TYPE_DVD_X2 0x00000002
+#define XBE_MEDIA_TYPE_DVD_CD 0x00000004
+#define XBE_MEDIA_TYPE_CD 0x00000008
+#define XBE_MEDIA_TYPE_DVD_5_RO 0x00000010
+#define XBE_MEDIA_TYPE_DVD_9_RO 0x00000020
+#define XBE_MEDIA_TYPE_DVD_5_RW 0x00000040
+#define XBE_MEDIA_TYPE_DVD_9_RW 0x00000080
+#define XBE_MEDIA_TYPE_NONSECURE_MODE 0x80000000
+#define XBE_MEDIA_TYPE_DISC_MASK 0x800000FE
+
+#define XBE_GAME_REGION_NA 0x00000001
+#define XBE_GAME_REGION_JAPAN 0x00000002
+#define XBE_GAME_REGION_RESTOFWORLD 0x00000004
+#define XBE_GAME_REGION_MANUFACTURING 0x80000000
+
+class xbeHeader
+{
+public:
+
+	typedef enum xbeResult
+	{
+		xbeResultOk = 0,
+		xbeResultReadFailed = 1,
+		xbeResultBadMagic = 2,
+		xbeResultBadBaseAddress = 3,
+		xbeResultBadHeaderSize = 4,
+		xbeResultBadSectionTable = 5,
+		xbeResultBadCertificate = 6,
+		xbeResultBadMediaType = 7,
+		xbeResultBadRegion = 8
+	} xbeResult;
+
+	typedef struct xbeInfo
+	{
+		uint32_t baseAddress;
+		uint32_t sizeOfHeaders;
+		uint32_t sizeOfImage;
+		uint32_t timeDate;
+		uint32_t sectionCount;
+		uint32_t preloadSize;
+		uint32_t deferredSize;
+		uint32_t titleId;
+		uint32_t allowedMediaTypes;
+		uint32_t gameRegion;
+		uint32_t diskNumber;
+		uint32_t version;
+		char titleName[41];
+	} xbeInfo;
+
+	// Parses a complete header block (sizeOfHeaders bytes) already in memory,
+	// has no file system or kernel dependencies.
+	static xbeResult parse(const uint8_t* buffer, uint32_t length, xbeInfo& info);
+	static xbeResult read(const char* path, xbeInfo& info);
+	static xbeResult readIdentity(const char* path, xbeInfo& info);
+	static xbeResult validate(const xbeInfo& info, uint32_t gameRegion);
+	static const char* getResultString(xbeResult result);
+};
@@ -4,6 +4,8 @@
 
 #define WSAWOULDBLOCK 10035
 
+// Host builds (see Tests) stand in for xtl.h and take these from stdint.h
+#if defined(_XBOX)
 typedef signed char int8_t;
 typedef short int16_t;
 typedef long int32_t;
@@ -12,6 +14,9 @@ typedef unsigned char uint8_t;
 typedef unsigned short uint16_t;
 typedef unsigned long uint32_t;
 typedef unsigned long long uint64_t;
+#else
+#include <stdint.h>
+#endif
 
 #define I2C_HDMI_ADDRESS1 0x88
 #define I2C_HDMI_ADDRESS2 0x86
@@ -134,6 +139,21 @@ typedef struct _STRING {
 	PCHAR Buffer;
 } STRING;
 
+typedef struct _IO_STATUS_BLOCK {
+	NTSTATUS Status;
+	ULONG Information;
+} IO_STATUS_BLOCK;
+
+typedef struct _OBJECT_ATTRIBUTES {
+	HANDLE RootDirectory;
+	STRING* ObjectName;
+	ULONG Attributes;
+} OBJECT_ATTRIBUTES;
+
+#define OBJ_CASE_INSENSITIVE 0x00000040
+#define FILE_SYNCHRONOUS_IO_NONALERT 0x00000020
+#define IOCTL_CDROM_READ_TOC 0x00024000
+
 typedef struct {
     BYTE        abSeed[20];                     // Last random seed
     IN_ADDR     ina;                            // Static IP address (0 for DHCP)
@@ -261,6 +281,7 @@ extern "C"
 	NTSTATUS WINAPI HalReadSMBusValue(UCHAR devddress, UCHAR offset, UCHAR readdw, DWORD* pdata);
 	NTSTATUS WINAPI HalReadSMCTrayState(ULONG* TrayState, ULONG* EjectCount);
 	NTSTATUS WINAPI KeDelayExecutionThread(CHAR WaitMode, BOOLEAN Alertable, PLARGE_INTEGER Interval);
+	NTSTATUS WINAPI NtOpenFile(HANDLE* FileHandle, ACCESS_MASK DesiredAccess, OBJECT_ATTRIBUTES* ObjectAttributes, IO_STATUS_BLOCK* IoStatusBlock, ULONG ShareAccess, ULONG OpenOptions);
 
 	NTSTATUS WINAPI XNetLoadConfigParams(XNetConfigParams* params);
 	NTSTATUS WINAPI XNetSaveConfigParams(const XNetConfigParams* params);
@@ -272,6 +293,10 @@ extern "C"
 
 	void __stdcall MmPersistContiguousMemory(PVOID BaseAddress, ULONG NumberOfBytes, BOOLEAN Persist);
 	void* __stdcall MmAllocateContiguousMemory(ULONG NumberOfBytes);
+	void* __stdcall MmAllocateContiguousMemoryEx(ULONG NumberOfBytes, ULONG LowestAcceptableAddress, ULONG HighestAcceptableAddress, ULONG Alignment, ULONG ProtectionType);
+	void* __stdcall MmMapIoSpace(ULONG PhysicalAddress, ULONG NumberOfBytes, ULONG ProtectionType);
+	void __stdcall MmUnmapIoSpace(PVOID BaseAddress, ULONG NumberOfBytes);
+	VOID WINAPI KeQuerySystemTime(PLARGE_INTEGER CurrentTime);
 }
 
 #define HalReadSMBusByte(SlaveAddress, CommandCode, DataValue) HalReadSMBusValue(SlaveAddress, CommandCode, FALSE, DataValue)
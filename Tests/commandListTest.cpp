@@ -0,0 +1,121 @@
+#include "hostTest.h"
+#include "commandList.h"
+#include "headlessCommandBackend.h"
+
+#define TRIANGLE_LIST 4
+#define QUAD_VERTICES 4
+#define VERTEX_FLOATS 6
+#define VERTEX_STRIDE (VERTEX_FLOATS * sizeof(float))
+#define FRAME_FILE_NAME "frame.cmd"
+
+// Records frames the way spriteBatch does, vertices written into the
+// stream, and checks the headless backend hashes what was drawn rather
+// than where the buffers happened to live.
+namespace
+{
+	void recordFrame(uint32_t textureHandle, uint32_t bufferHandle, uint32_t quadCount, float offset, uint32_t baseVertex)
+	{
+		commandList::setRenderState(137, 1);
+		commandList::setTexture(0, textureHandle);
+		commandList::setStreamSource(0, bufferHandle, VERTEX_STRIDE);
+
+		uint32_t vertexCount = quadCount * QUAD_VERTICES;
+		float* vertices = (float*)commandList::setVertices(vertexCount, VERTEX_STRIDE);
+		hostTest::check(vertices != NULL, "no room for %u vertices", vertexCount);
+		for (uint32_t i = 0; vertices != NULL && i < vertexCount * VERTEX_FLOATS; i++)
+		{
+			vertices[i] = offset + (float)i;
+		}
+		commandList::setIndices(bufferHandle + 0x1000, baseVertex);
+		commandList::drawIndexed(TRIANGLE_LIST, 0, vertexCount, 0, quadCount * 2);
+		commandList::endFrame();
+	}
+
+	void testHash()
+	{
+		headlessCommandBackend backend;
+		commandList::setBackend(&backend);
+		headlessCommandBackend::headlessStats stats;
+
+		recordFrame(0x80001000, 0x80002000, 3, 0, 0);
+		backend.getStats(stats);
+		uint32_t firstHash = stats.lastFrameHash;
+		hostTest::check(stats.frames == 1 && stats.draws == 1 && stats.lastFramePrimitives == 6, "frame counted %u frames, %u draws", stats.frames, stats.draws);
+		hostTest::check(stats.recordedVertices == 12 && stats.vertexBytes == 12 * VERTEX_STRIDE, "%u vertices in %u bytes recorded", stats.recordedVertices, stats.vertexBytes);
+
+		// Same drawing from buffers at other addresses
+		recordFrame(0x80005000, 0x80009000, 3, 0, 0);
+		backend.getStats(stats);
+		hostTest::check(stats.lastFrameHash == firstHash, "moved handles changed the hash to %08x from %08x", stats.lastFrameHash, firstHash);
+
+		// Same drawing from further along the vertex ring
+		recordFrame(0x80001000, 0x80002000, 3, 0, 4096);
+		backend.getStats(stats);
+		hostTest::check(stats.lastFrameHash == firstHash, "ring offset changed the hash to %08x from %08x", stats.lastFrameHash, firstHash);
+
+		recordFrame(0x80001000, 0x80002000, 3, 0.5f, 0);
+		backend.getStats(stats);
+		hostTest::check(stats.lastFrameHash != firstHash, "changed vertices kept hash %08x", firstHash);
+		hostTest::check(stats.opCounts[commandOpSetVertices] == 4 && stats.vertices == 48, "%u set vertices for %u vertices", stats.opCounts[commandOpSetVertices], stats.vertices);
+
+		commandList::setBackend(NULL);
+	}
+
+	void testFile(const char* directory)
+	{
+		recordFrame(0x80001000, 0x80002000, 5, 2, 0);
+		const uint32_t* commands = NULL;
+		uint32_t dwordCount = 0;
+		commandList::getLastFrame(commands, dwordCount);
+
+		headlessCommandBackend recorded;
+		hostTest::check(commandList::replay(commands, dwordCount, &recorded) == true, "recorded frame did not replay");
+
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%s", directory, FRAME_FILE_NAME);
+		FILE* file = fopen(path, "wb");
+		hostTest::check(file != NULL, "unable to write %s", path);
+		if (file == NULL)
+		{
+			return;
+		}
+		fwrite(commands, sizeof(uint32_t), dwordCount, file);
+		fclose(file);
+
+		uint32_t* loaded = (uint32_t*)malloc(dwordCount * sizeof(uint32_t));
+		file = fopen(path, "rb");
+		uint32_t loadedCount = (uint32_t)fread(loaded, sizeof(uint32_t), dwordCount, file);
+		fclose(file);
+
+		headlessCommandBackend replayed;
+		hostTest::check(loadedCount == dwordCount && commandList::replay(loaded, loadedCount, &replayed) == true, "saved frame did not replay");
+		headlessCommandBackend::headlessStats recordedStats;
+		headlessCommandBackend::headlessStats replayedStats;
+		recorded.getStats(recordedStats);
+		replayed.getStats(replayedStats);
+		hostTest::check(replayedStats.lastFrameHash == recordedStats.lastFrameHash && replayedStats.recordedVertices == 20, "saved frame hashed %08x with %u vertices", replayedStats.lastFrameHash, replayedStats.recordedVertices);
+
+		// A vertex count larger than the bytes carried is rejected
+		uint32_t offset = 0;
+		while (offset < loadedCount && (loaded[offset] & 0xff) != commandOpSetVertices)
+		{
+			offset += 1 + (loaded[offset] >> 8);
+		}
+		hostTest::check(offset < loadedCount, "saved frame has no vertices");
+		if (offset < loadedCount)
+		{
+			loaded[offset + 1]++;
+			headlessCommandBackend rejected;
+			hostTest::check(commandList::replay(loaded, loadedCount, &rejected) == false, "oversized vertex count replayed");
+		}
+		hostTest::check(commandList::replay(loaded, loadedCount - 1, &replayed) == false, "truncated frame replayed");
+		free(loaded);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	testHash();
+	testFile(argc > 1 ? argv[1] : ".");
+	return hostTest::result();
+}
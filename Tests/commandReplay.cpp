@@ -0,0 +1,53 @@
+#include "commandList.h"
+#include "headlessCommandBackend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Replays a frame.cmd captured on the console through the headless
+// backend and prints what it drew, diff the output between builds to see
+// draw changes.
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: commandReplay frame.cmd\n");
+		return 2;
+	}
+
+	FILE* file = fopen(argv[1], "rb");
+	if (file == NULL)
+	{
+		printf("Unable to open %s\n", argv[1]);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint32_t dwordCount = length > 0 ? (uint32_t)(length / sizeof(uint32_t)) : 0;
+	uint32_t* commands = (uint32_t*)malloc(dwordCount == 0 ? 1 : dwordCount * sizeof(uint32_t));
+	uint32_t readCount = (uint32_t)fread(commands, sizeof(uint32_t), dwordCount, file);
+	fclose(file);
+
+	headlessCommandBackend backend;
+	bool replayed = readCount == dwordCount && dwordCount > 0 && commandList::replay(commands, dwordCount, &backend) == true;
+	free(commands);
+	if (replayed == false)
+	{
+		printf("%s is not a valid command stream\n", argv[1]);
+		return 1;
+	}
+
+	headlessCommandBackend::headlessStats stats;
+	backend.getStats(stats);
+	printf("Frames: %u, commands: %u\n", stats.frames, stats.commands);
+	printf("Draws: %u, primitives: %u, vertices: %u\n", stats.draws, stats.primitives, stats.vertices);
+	printf("Recorded vertices: %u in %u bytes\n", stats.recordedVertices, stats.vertexBytes);
+	printf("Last frame: %u draws, %u primitives, hash %08x\n", stats.lastFrameDraws, stats.lastFramePrimitives, stats.lastFrameHash);
+	if (stats.frames == 0 || stats.recordedVertices != stats.vertices)
+	{
+		printf("Draws read vertices the stream does not carry\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include "hostTest.h"
+#include "discWorker.h"
+
+#define TEST_DEADLINE 50
+
+// A job that outlives its deadline is abandoned at once so the drive can
+// be dismounted under it, nothing else may start on the drive until its
+// thread has returned.
+namespace
+{
+	volatile LONG mMounted = 1;
+	volatile LONG mInside = 0;
+
+	// Stands in for I/O blocked on a hung drive, only the dismount fails it
+	void hangingJob(void* userData)
+	{
+		InterlockedIncrement(&mInside);
+		while (mMounted != 0)
+		{
+			Sleep(1);
+		}
+		*(uint32_t*)userData = 1;
+		InterlockedDecrement(&mInside);
+	}
+
+	void unmountDrive()
+	{
+		InterlockedExchange(&mMounted, 0);
+	}
+
+	void quickJob(void* userData)
+	{
+		*(uint32_t*)userData = 2;
+	}
+
+	discJobState pollUntilChanged(discJobState state, void** userData)
+	{
+		discJobState result = state;
+		for (uint32_t i = 0; i < 1000 && result == state; i++)
+		{
+			Sleep(1);
+			result = discWorker::poll(userData);
+		}
+		return result;
+	}
+
+	void testCompleted()
+	{
+		uint32_t* value = (uint32_t*)malloc(sizeof(uint32_t));
+		hostTest::check(discWorker::start(quickJob, value, TEST_DEADLINE * 10), "start refused while idle");
+		void* userData = NULL;
+		discJobState state = pollUntilChanged(discJobStateRunning, &userData);
+		hostTest::check(state == discJobStateCompleted && userData == value && *value == 2, "quick job finished as state %u", state);
+		free(userData);
+		hostTest::check(discWorker::isBusy() == false, "worker busy after completing");
+	}
+
+	void testAbandoned()
+	{
+		uint32_t* value = (uint32_t*)malloc(sizeof(uint32_t));
+		hostTest::check(discWorker::start(hangingJob, value, TEST_DEADLINE), "start refused while idle");
+
+		void* userData = NULL;
+		discJobState state = pollUntilChanged(discJobStateRunning, &userData);
+		hostTest::check(state == discJobStateStalled && userData == NULL, "hung job finished as state %u", state);
+		hostTest::check(mInside == 1, "stalled job is not inside its callback");
+
+		// The worker frees up at once, only starting another job waits
+		hostTest::check(discWorker::isBusy() == false, "worker busy after abandoning its job");
+		hostTest::check(discWorker::poll(&userData) == discJobStateIdle, "abandoned job still polled");
+		uint32_t* second = (uint32_t*)malloc(sizeof(uint32_t));
+		for (uint32_t i = 0; i < 5; i++)
+		{
+			Sleep(TEST_DEADLINE);
+			hostTest::check(discWorker::hasAbandonedJob() == true && mInside == 1, "hung job left the drive before the unmount");
+			hostTest::check(discWorker::start(quickJob, second, TEST_DEADLINE) == false, "second job started beside an abandoned one");
+		}
+
+		// Nothing polls here, the thread frees its own job on the way out
+		unmountDrive();
+		for (uint32_t i = 0; i < 1000 && discWorker::hasAbandonedJob() == true; i++)
+		{
+			Sleep(1);
+		}
+		hostTest::check(discWorker::hasAbandonedJob() == false && mInside == 0, "job still inside after the unmount");
+
+		hostTest::check(discWorker::start(quickJob, second, TEST_DEADLINE * 10), "start refused after abandoned job exited");
+		state = pollUntilChanged(discJobStateRunning, &userData);
+		hostTest::check(state == discJobStateCompleted && userData == second, "job after abandoned one finished as state %u", state);
+		free(userData);
+
+		discWorker::discWorkerStats stats;
+		discWorker::getStats(stats);
+		hostTest::check(stats.stalls == 1, "%u stalls counted", stats.stalls);
+	}
+}
+
+int main()
+{
+	testCompleted();
+	testAbandoned();
+	return hostTest::result();
+}
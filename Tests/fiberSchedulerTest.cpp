@@ -0,0 +1,151 @@
+#include "hostTest.h"
+#include "fiberScheduler.h"
+
+// Runs the scheduler on the ucontext backend, each fiber keeps its own
+// stack across switches and only the main fiber drives run.
+namespace
+{
+	char mOrder[64];
+	uint32_t mOrderLength = 0;
+
+	void appendOrder(char value)
+	{
+		if (mOrderLength < sizeof(mOrder) - 1)
+		{
+			mOrder[mOrderLength++] = value;
+			mOrder[mOrderLength] = 0;
+		}
+	}
+
+	void resetOrder()
+	{
+		mOrderLength = 0;
+		mOrder[0] = 0;
+	}
+
+	// Locals must survive every switch for the stacks to be separate
+	void countingFiber(void* userData)
+	{
+		char name = *(char*)userData;
+		uint32_t steps = 0;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			appendOrder(name);
+			steps++;
+			fiberScheduler::yield();
+		}
+		hostTest::check(steps == 3 && name == *(char*)userData, "fiber %c lost its locals", *(char*)userData);
+	}
+
+	void sleepingFiber(void* userData)
+	{
+		double start = fiberBackend::getMilliseconds();
+		fiberScheduler::sleep(20);
+		*(double*)userData = fiberBackend::getMilliseconds() - start;
+	}
+
+	void busyFiber(void* userData)
+	{
+		uint32_t* yields = (uint32_t*)userData;
+		double end = fiberBackend::getMilliseconds() + 30;
+		while (fiberBackend::getMilliseconds() < end)
+		{
+			if (fiberScheduler::yieldIfOverBudget() == true)
+			{
+				(*yields)++;
+			}
+		}
+	}
+
+	void spawningFiber(void* userData)
+	{
+		hostTest::check(fiberScheduler::isInFiber() == true, "fiber does not report being in a fiber");
+		*(int32_t*)userData = fiberScheduler::spawn("nested", countingFiber, NULL, 0);
+	}
+
+	// Each pass stands in for a frame, so sleeping fibers see time pass
+	void runUntilDone(int32_t taskId, double budgetMilliseconds)
+	{
+		for (uint32_t i = 0; i < 1000 && fiberScheduler::isDone(taskId) == false; i++)
+		{
+			fiberScheduler::run(budgetMilliseconds);
+			Sleep(1);
+		}
+	}
+
+	void testRoundRobin()
+	{
+		resetOrder();
+		char names[2] = { 'a', 'b' };
+		int32_t first = fiberScheduler::spawn("a", countingFiber, &names[0], 0);
+		int32_t second = fiberScheduler::spawn("b", countingFiber, &names[1], 16 * 1024);
+		hostTest::check(first >= 0 && second >= 0, "spawn failed with %d and %d", first, second);
+		hostTest::check(fiberScheduler::getTaskCount() == 2, "%u tasks after spawning two", fiberScheduler::getTaskCount());
+
+		runUntilDone(second, 1000);
+		hostTest::check(strcmp(mOrder, "ababab") == 0, "fibers ran \"%s\"", mOrder);
+		hostTest::check(fiberScheduler::isDone(first) == true && fiberScheduler::isDone(second) == true, "fibers not done after their entry returned");
+		hostTest::check(fiberScheduler::getTaskCount() == 0, "%u tasks left after finishing", fiberScheduler::getTaskCount());
+
+		// Finished slots are handed out again
+		int32_t reused = fiberScheduler::spawn("a", countingFiber, &names[0], 0);
+		hostTest::check(reused == first, "spawn used slot %d instead of %d", reused, first);
+		runUntilDone(reused, 1000);
+	}
+
+	void testSleep()
+	{
+		double slept = 0;
+		int32_t taskId = fiberScheduler::spawn("sleep", sleepingFiber, &slept, 0);
+		fiberScheduler::run(1000);
+		hostTest::check(fiberScheduler::isDone(taskId) == false, "sleeping fiber finished in the first pass");
+		runUntilDone(taskId, 1);
+		hostTest::check(fiberScheduler::isDone(taskId) == true && slept >= 20, "fiber woke after %.2fms", slept);
+	}
+
+	void testBudget()
+	{
+		uint32_t yields = 0;
+		int32_t taskId = fiberScheduler::spawn("busy", busyFiber, &yields, 0);
+		fiberScheduler::fiberStats before;
+		fiberScheduler::getStats(before);
+
+		uint32_t passes = 0;
+		while (fiberScheduler::isDone(taskId) == false && passes < 1000)
+		{
+			double start = fiberBackend::getMilliseconds();
+			fiberScheduler::run(2);
+			double elapsed = fiberBackend::getMilliseconds() - start;
+			hostTest::check(elapsed < 15, "pass with a 2ms budget took %.2fms", elapsed);
+			passes++;
+		}
+		hostTest::check(fiberScheduler::isDone(taskId) == true && yields > 1, "busy fiber yielded %u times", yields);
+
+		fiberScheduler::fiberStats after;
+		fiberScheduler::getStats(after);
+		hostTest::check(after.overBudgetFrames > before.overBudgetFrames, "no pass counted as over budget");
+	}
+
+	void testSpawnFromFiber()
+	{
+		int32_t nested = 0;
+		int32_t taskId = fiberScheduler::spawn("spawner", spawningFiber, &nested, 0);
+		runUntilDone(taskId, 1000);
+		hostTest::check(nested == -1, "spawn from a fiber returned %d", nested);
+		hostTest::check(fiberScheduler::isInFiber() == false, "main fiber reports being in a fiber");
+	}
+}
+
+int main()
+{
+	hostTest::check(fiberScheduler::init() == true, "init failed");
+	testRoundRobin();
+	testSleep();
+	testBudget();
+	testSpawnFromFiber();
+
+	fiberScheduler::fiberStats stats;
+	fiberScheduler::getStats(stats);
+	hostTest::check(stats.spawned == stats.completed, "%u spawned but %u completed", stats.spawned, stats.completed);
+	return hostTest::result();
+}
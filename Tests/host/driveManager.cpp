@@ -0,0 +1,14 @@
+#include "driveManager.h"
+
+// Host stand-in, every drive is a directory under the hostFileSystem root
+// and is always mounted.
+
+bool driveManager::mountDrive(const char* driveLetter)
+{
+	return true;
+}
+
+bool driveManager::mountInsertedDrive(const char* driveLetter)
+{
+	return true;
+}
@@ -0,0 +1,265 @@
+#include "fileSystem.h"
+#include "hostFileSystem.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+// Host stand-in for the parts of fileSystem the tested modules reach,
+// backed by stdio under the root set with hostFileSystem::setRoot.
+
+#define HOST_MAX_FILES 16
+
+namespace
+{
+	std::string mRoot = ".";
+
+	// Handles are slot + 1, a FILE* does not fit the 32 bit handle on 64 bit hosts
+	FILE* mFiles[HOST_MAX_FILES];
+
+	FILE* getFile(uint32_t fileHandle)
+	{
+		if (fileHandle == 0 || fileHandle > HOST_MAX_FILES)
+		{
+			return NULL;
+		}
+		return mFiles[fileHandle - 1];
+	}
+
+	int removeEntry(const char* path, const struct stat* status, int type, struct FTW* ftw)
+	{
+		return remove(path);
+	}
+
+	bool makeDirectories(const std::string& path)
+	{
+		for (size_t i = 1; i <= path.length(); i++)
+		{
+			if (i != path.length() && path[i] != '/')
+			{
+				continue;
+			}
+			std::string parent = path.substr(0, i);
+			if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void hostFileSystem::setRoot(const char* root)
+{
+	mRoot = root;
+}
+
+std::string hostFileSystem::mapPath(const char* path)
+{
+	std::string result = mRoot;
+	result += "/";
+	for (const char* current = path; *current != 0; current++)
+	{
+		if (*current == ':')
+		{
+			continue;
+		}
+		result += *current == '\\' ? '/' : *current;
+	}
+	return result;
+}
+
+bool hostFileSystem::createFile(const char* path, const uint8_t* buffer, uint32_t length)
+{
+	std::string hostPath = mapPath(path);
+	size_t separator = hostPath.rfind('/');
+	if (separator != std::string::npos && makeDirectories(hostPath.substr(0, separator)) == false)
+	{
+		return false;
+	}
+	uint32_t bytesWritten = 0;
+	return fileSystem::fileWrite(path, (char*)buffer, length, bytesWritten) && bytesWritten == length;
+}
+
+bool hostFileSystem::removeTree(const char* path)
+{
+	std::string hostPath = mapPath(path);
+	struct stat status;
+	if (stat(hostPath.c_str(), &status) != 0)
+	{
+		return true;
+	}
+	return nftw(hostPath.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS) == 0;
+}
+
+bool fileSystem::fileOpen(const char* path, FileMode const fileMode, uint32_t& fileHandle)
+{
+	const char* modes[] = { "rb", "wb", "ab", "r+b", "w+b", "a+b" };
+	for (uint32_t i = 0; i < HOST_MAX_FILES; i++)
+	{
+		if (mFiles[i] != NULL)
+		{
+			continue;
+		}
+		mFiles[i] = fopen(hostFileSystem::mapPath(path).c_str(), modes[fileMode]);
+		if (mFiles[i] == NULL)
+		{
+			return false;
+		}
+		fileHandle = i + 1;
+		return true;
+	}
+	return false;
+}
+
+bool fileSystem::fileRead(uint32_t fileHandle, char* readBuffer, uint32_t const bytesToRead, uint32_t& bytesRead)
+{
+	FILE* file = getFile(fileHandle);
+	if (file == NULL)
+	{
+		return false;
+	}
+	bytesRead = (uint32_t)fread(readBuffer, 1, bytesToRead, file);
+	return ferror(file) == 0;
+}
+
+bool fileSystem::fileWrite(uint32_t fileHandle, char* writeBuffer, uint32_t bytesToWrite, uint32_t& bytesWritten)
+{
+	FILE* file = getFile(fileHandle);
+	if (file == NULL)
+	{
+		return false;
+	}
+	bytesWritten = (uint32_t)fwrite(writeBuffer, 1, bytesToWrite, file);
+	return bytesWritten == bytesToWrite;
+}
+
+bool fileSystem::fileWrite(const char* path, char* writeBuffer, uint32_t bytesToWrite, uint32_t& bytesWritten)
+{
+	uint32_t fileHandle;
+	if (fileOpen(path, FileModeWrite, fileHandle) == false)
+	{
+		return false;
+	}
+	bool result = fileWrite(fileHandle, writeBuffer, bytesToWrite, bytesWritten);
+	fileClose(fileHandle);
+	return result;
+}
+
+bool fileSystem::fileClose(uint32_t fileHandle)
+{
+	FILE* file = getFile(fileHandle);
+	if (file == NULL)
+	{
+		return false;
+	}
+	mFiles[fileHandle - 1] = NULL;
+	return fclose(file) == 0;
+}
+
+bool fileSystem::fileSize(uint32_t fileHandle, uint32_t& size)
+{
+	FILE* file = getFile(fileHandle);
+	struct stat status;
+	if (file == NULL || fstat(fileno(file), &status) != 0)
+	{
+		return false;
+	}
+	size = (uint32_t)status.st_size;
+	return true;
+}
+
+bool fileSystem::fileExists(const char* path, bool& exists)
+{
+	struct stat status;
+	exists = stat(hostFileSystem::mapPath(path).c_str(), &status) == 0 && S_ISREG(status.st_mode);
+	return true;
+}
+
+bool fileSystem::directoryExists(const char* path, bool& exists)
+{
+	struct stat status;
+	exists = stat(hostFileSystem::mapPath(path).c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+	return true;
+}
+
+bool fileSystem::directoryCreate(const char* path)
+{
+	return makeDirectories(hostFileSystem::mapPath(path));
+}
+
+pointerVector* fileSystem::fileGetDirectoryEntries(const char* path)
+{
+	pointerVector* fileInfoDetails = new pointerVector(true);
+
+	std::string hostPath = hostFileSystem::mapPath(path);
+	DIR* directory = opendir(hostPath.c_str());
+	if (directory == NULL)
+	{
+		return fileInfoDetails;
+	}
+
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != NULL)
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+		{
+			continue;
+		}
+
+		struct stat status;
+		std::string entryPath = hostPath + "/" + entry->d_name;
+		if (stat(entryPath.c_str(), &status) != 0)
+		{
+			continue;
+		}
+
+		FileInfoDetail* fileInfoDetail = new FileInfoDetail();
+		fileInfoDetail->path = combinePath(path, entry->d_name);
+		fileInfoDetail->isDirectory = S_ISDIR(status.st_mode);
+		fileInfoDetail->isFile = S_ISDIR(status.st_mode) == false;
+		fileInfoDetail->size = (uint32_t)status.st_size;
+		fileInfoDetails->add(fileInfoDetail);
+	}
+	closedir(directory);
+	return fileInfoDetails;
+}
+
+char* fileSystem::getFileName(const char* path)
+{
+	const char* separator = strrchr(path, '\\');
+	return strdup(separator == NULL ? path : separator + 1);
+}
+
+char* fileSystem::getDirectory(const char* path)
+{
+	const char* separator = strrchr(path, '\\');
+	if (separator == NULL)
+	{
+		return strdup("");
+	}
+	return strndup(path, separator - path);
+}
+
+char* fileSystem::combinePath(const char* first, const char* second)
+{
+	std::string trimmedFirst = first;
+	while (trimmedFirst.length() > 0 && trimmedFirst[trimmedFirst.length() - 1] == '\\')
+	{
+		trimmedFirst.erase(trimmedFirst.length() - 1);
+	}
+	while (*second == '\\')
+	{
+		second++;
+	}
+	if (trimmedFirst.length() == 0)
+	{
+		return strdup(second);
+	}
+	if (*second == 0)
+	{
+		return strdup(trimmedFirst.c_str());
+	}
+	return strdup((trimmedFirst + "\\" + second).c_str());
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#include <string>
+
+// The host fileSystem maps Xbox paths onto a directory, "D:\a\b.xbe"
+// becomes "<root>/D/a/b.xbe", so tests can lay out discs and E: files.
+class hostFileSystem
+{
+public:
+	static void setRoot(const char* root);
+	static std::string mapPath(const char* path);
+	static bool createFile(const char* path, const uint8_t* buffer, uint32_t length);
+	static bool removeTree(const char* path);
+};
@@ -0,0 +1,3 @@
+#pragma once
+
+// Empty stand-in, drive.h pulls this in but nothing in the host build uses it
@@ -0,0 +1,231 @@
+#include "xboxinternals.h"
+#include "xbeHeader.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	typedef struct hostThread
+	{
+		pthread_t thread;
+		bool joined;
+	} hostThread;
+
+	// Owned by the new thread, the handle may be closed before it runs
+	typedef struct hostThreadStart
+	{
+		LPTHREAD_START_ROUTINE startAddress;
+		LPVOID param;
+	} hostThreadStart;
+
+	void* threadEntry(void* param)
+	{
+		hostThreadStart start = *(hostThreadStart*)param;
+		delete((hostThreadStart*)param);
+		start.startAddress(start.param);
+		return NULL;
+	}
+
+	uint64_t getNanoseconds()
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+	}
+}
+
+HANDLE CreateThread(void* attributes, DWORD stackSize, LPTHREAD_START_ROUTINE startAddress, LPVOID param, DWORD creationFlags, DWORD* threadId)
+{
+	hostThreadStart* start = new hostThreadStart();
+	start->startAddress = startAddress;
+	start->param = param;
+
+	hostThread* thread = new hostThread();
+	thread->joined = false;
+	if (pthread_create(&thread->thread, NULL, threadEntry, start) != 0)
+	{
+		delete(start);
+		delete(thread);
+		return NULL;
+	}
+	return (HANDLE)thread;
+}
+
+// Only thread handles are ever waited on
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+	hostThread* thread = (hostThread*)handle;
+	pthread_join(thread->thread, NULL);
+	thread->joined = true;
+	return 0;
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+	hostThread* thread = (hostThread*)handle;
+	if (thread->joined == false)
+	{
+		pthread_detach(thread->thread);
+	}
+	delete(thread);
+	return TRUE;
+}
+
+VOID Sleep(DWORD milliseconds)
+{
+	usleep((useconds_t)milliseconds * 1000);
+}
+
+DWORD GetTickCount()
+{
+	return (DWORD)(getNanoseconds() / 1000000);
+}
+
+LONG InterlockedIncrement(volatile LONG* addend)
+{
+	return __sync_add_and_fetch(addend, 1);
+}
+
+LONG InterlockedDecrement(volatile LONG* addend)
+{
+	return __sync_sub_and_fetch(addend, 1);
+}
+
+LONG InterlockedExchange(volatile LONG* target, LONG value)
+{
+	__sync_synchronize();
+	return __sync_lock_test_and_set(target, value);
+}
+
+LONG InterlockedCompareExchange(volatile LONG* destination, LONG exchange, LONG comparand)
+{
+	return __sync_val_compare_and_swap(destination, comparand, exchange);
+}
+
+VOID InitializeCriticalSection(CRITICAL_SECTION* criticalSection)
+{
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_t* mutex = new pthread_mutex_t;
+	pthread_mutex_init(mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+	criticalSection->mutex = mutex;
+}
+
+VOID DeleteCriticalSection(CRITICAL_SECTION* criticalSection)
+{
+	pthread_mutex_t* mutex = (pthread_mutex_t*)criticalSection->mutex;
+	pthread_mutex_destroy(mutex);
+	delete(mutex);
+	criticalSection->mutex = NULL;
+}
+
+VOID EnterCriticalSection(CRITICAL_SECTION* criticalSection)
+{
+	pthread_mutex_lock((pthread_mutex_t*)criticalSection->mutex);
+}
+
+VOID LeaveCriticalSection(CRITICAL_SECTION* criticalSection)
+{
+	pthread_mutex_unlock((pthread_mutex_t*)criticalSection->mutex);
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	counter->QuadPart = (int64_t)getNanoseconds();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+int _vsnprintf(char* buffer, size_t count, const char* format, va_list args)
+{
+	va_list copy;
+	va_copy(copy, args);
+	int length = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (buffer == NULL || count == 0 || length < 0)
+	{
+		return length;
+	}
+
+	char* message = (char*)malloc(length + 1);
+	va_copy(copy, args);
+	vsnprintf(message, length + 1, format, copy);
+	va_end(copy);
+	memcpy(buffer, message, min((size_t)length + 1, count));
+	free(message);
+	return (size_t)length < count ? length : -1;
+}
+
+VOID OutputDebugStringA(LPCSTR message)
+{
+	fputs(message, stdout);
+}
+
+// There is no drive on the host, device reads fail like an empty one
+DWORD SetFilePointer(HANDLE file, LONG distanceToMove, LONG* distanceToMoveHigh, DWORD moveMethod)
+{
+	return INVALID_SET_FILE_POINTER;
+}
+
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD bytesToRead, DWORD* bytesRead, void* overlapped)
+{
+	*bytesRead = 0;
+	return FALSE;
+}
+
+BOOL DeviceIoControl(HANDLE device, DWORD ioControlCode, LPVOID inBuffer, DWORD inBufferSize, LPVOID outBuffer, DWORD outBufferSize, DWORD* bytesReturned, void* overlapped)
+{
+	return FALSE;
+}
+
+DWORD GetLastError()
+{
+	return 1;
+}
+
+DWORD XGetGameRegion()
+{
+	return XBE_GAME_REGION_NA;
+}
+
+// Kernel exports reached by the tested modules. Tests swap in their own
+// readers and writers through the module seams, these are the defaults.
+
+extern "C" NTSTATUS WINAPI HalReadSMCTrayState(ULONG* trayState, ULONG* ejectCount)
+{
+	*trayState = SMC_TRAY_STATE_CLOSED;
+	if (ejectCount != NULL)
+	{
+		*ejectCount = 0;
+	}
+	return STATUS_SUCCESS;
+}
+
+extern "C" NTSTATUS WINAPI HalWriteSMBusValue(UCHAR address, UCHAR offset, UCHAR writeWord, DWORD data)
+{
+	return STATUS_SUCCESS;
+}
+
+extern "C" NTSTATUS WINAPI NtOpenFile(HANDLE* fileHandle, ACCESS_MASK desiredAccess, OBJECT_ATTRIBUTES* objectAttributes, IO_STATUS_BLOCK* ioStatusBlock, ULONG shareAccess, ULONG openOptions)
+{
+	return -1;
+}
+
+extern "C" NTSTATUS WINAPI KeDelayExecutionThread(CHAR waitMode, BOOLEAN alertable, PLARGE_INTEGER interval)
+{
+	int64_t nanoseconds = -interval->QuadPart * 100;
+	struct timespec delay;
+	delay.tv_sec = (time_t)(nanoseconds / 1000000000);
+	delay.tv_nsec = (long)(nanoseconds % 1000000000);
+	nanosleep(&delay, NULL);
+	return STATUS_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// Stands in for the XDK's xtl.h so modules with no hardware dependency can
+// be built and tested on Linux. Only what those modules use is declared,
+// the kernel calls they reach are implemented in xtl.cpp.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <string>
+#include <algorithm>
+#include <sstream>
+
+#define WINAPI
+#define __stdcall
+#define __cdecl
+#define IN
+#define OUT
+#define VOID void
+
+typedef uint8_t BYTE;
+typedef uint8_t UCHAR;
+typedef char CHAR;
+typedef char* PCHAR;
+typedef const char* LPCSTR;
+typedef uint16_t USHORT;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uint32_t ULONG;
+typedef int32_t LONG;
+typedef int32_t INT;
+typedef uint32_t UINT;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef int32_t BOOL;
+typedef uint8_t BOOLEAN;
+typedef uint32_t ACCESS_MASK;
+typedef int32_t HRESULT;
+typedef void* HANDLE;
+typedef void* PVOID;
+typedef void* LPVOID;
+
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		uint32_t LowPart;
+		int32_t HighPart;
+	};
+	int64_t QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER;
+
+typedef struct in_addr
+{
+	uint32_t s_addr;
+} IN_ADDR;
+
+typedef struct _CRITICAL_SECTION
+{
+	void* mutex;
+} CRITICAL_SECTION;
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID param);
+
+#define TRUE 1
+#define FALSE 0
+#define INFINITE 0xffffffff
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define GENERIC_READ 0x80000000
+#define SYNCHRONIZE 0x00100000
+#define FILE_SHARE_READ 0x00000001
+#define FILE_BEGIN 0
+#define INVALID_SET_FILE_POINTER ((DWORD)-1)
+#define NO_ERROR 0
+#define S_OK 0
+#define FAILED(result) ((HRESULT)(result) < 0)
+#define SUCCEEDED(result) ((HRESULT)(result) >= 0)
+
+#define _snprintf snprintf
+#define _stricmp strcasecmp
+#define _strnicmp strncasecmp
+#define strnicmp strncasecmp
+
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+HANDLE CreateThread(void* attributes, DWORD stackSize, LPTHREAD_START_ROUTINE startAddress, LPVOID param, DWORD creationFlags, DWORD* threadId);
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+BOOL CloseHandle(HANDLE handle);
+VOID Sleep(DWORD milliseconds);
+DWORD GetTickCount();
+LONG InterlockedIncrement(volatile LONG* addend);
+LONG InterlockedDecrement(volatile LONG* addend);
+LONG InterlockedExchange(volatile LONG* target, LONG value);
+LONG InterlockedCompareExchange(volatile LONG* destination, LONG exchange, LONG comparand);
+VOID InitializeCriticalSection(CRITICAL_SECTION* criticalSection);
+VOID DeleteCriticalSection(CRITICAL_SECTION* criticalSection);
+VOID EnterCriticalSection(CRITICAL_SECTION* criticalSection);
+VOID LeaveCriticalSection(CRITICAL_SECTION* criticalSection);
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+VOID OutputDebugStringA(LPCSTR message);
+DWORD SetFilePointer(HANDLE file, LONG distanceToMove, LONG* distanceToMoveHigh, DWORD moveMethod);
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD bytesToRead, DWORD* bytesRead, void* overlapped);
+BOOL DeviceIoControl(HANDLE device, DWORD ioControlCode, LPVOID inBuffer, DWORD inBufferSize, LPVOID outBuffer, DWORD outBufferSize, DWORD* bytesReturned, void* overlapped);
+DWORD GetLastError();
+DWORD XGetGameRegion();
+
+// MSVC semantics, callers format twice from one va_list and size the
+// buffer to exactly the length, so args are copied and not consumed and
+// no terminator is written when the text fills the buffer.
+int _vsnprintf(char* buffer, size_t count, const char* format, va_list args);
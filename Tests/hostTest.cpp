@@ -0,0 +1,30 @@
+#include "hostTest.h"
+
+namespace
+{
+	uint32_t mChecks = 0;
+	uint32_t mFailures = 0;
+}
+
+void hostTest::check(bool condition, const char* format, ...)
+{
+	mChecks++;
+	if (condition == true)
+	{
+		return;
+	}
+	mFailures++;
+
+	va_list args;
+	va_start(args, format);
+	printf("FAILED: ");
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+}
+
+int hostTest::result()
+{
+	printf("%u checks, %u failed\n", mChecks, mFailures);
+	return mFailures == 0 ? 0 : 1;
+}
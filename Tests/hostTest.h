@@ -0,0 +1,12 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+// Minimal checks for the host tests, each test binary returns result()
+// from main so ctest sees any failed check.
+class hostTest
+{
+public:
+	static void check(bool condition, const char* format, ...);
+	static int result();
+};
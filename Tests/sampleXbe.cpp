@@ -0,0 +1,62 @@
+#include "sampleXbe.h"
+#include "xbeHeader.h"
+#include "host/hostFileSystem.h"
+
+#define SAMPLE_CERTIFICATE_OFFSET 0x200
+#define SAMPLE_SECTION_OFFSET 0x1400
+#define SAMPLE_SECTION_NAME_OFFSET 0x1500
+
+void sampleXbe::writeUInt32(uint8_t* buffer, uint32_t offset, uint32_t value)
+{
+	buffer[offset] = (uint8_t)value;
+	buffer[offset + 1] = (uint8_t)(value >> 8);
+	buffer[offset + 2] = (uint8_t)(value >> 16);
+	buffer[offset + 3] = (uint8_t)(value >> 24);
+}
+
+uint32_t sampleXbe::build(uint8_t* buffer, uint32_t titleId, uint32_t gameRegion, const char* titleName)
+{
+	memset(buffer, 0, SAMPLE_XBE_SIZE);
+
+	writeUInt32(buffer, 0x000, XBE_MAGIC);
+	writeUInt32(buffer, 0x104, XBE_BASE_ADDRESS);
+	writeUInt32(buffer, 0x108, SAMPLE_XBE_SIZE);
+	writeUInt32(buffer, 0x10C, 0x20000);
+	writeUInt32(buffer, 0x114, 0x3C000000);
+	writeUInt32(buffer, 0x118, XBE_BASE_ADDRESS + SAMPLE_CERTIFICATE_OFFSET);
+	writeUInt32(buffer, 0x11C, 2);
+	writeUInt32(buffer, 0x120, XBE_BASE_ADDRESS + SAMPLE_SECTION_OFFSET);
+
+	uint8_t* certificate = buffer + SAMPLE_CERTIFICATE_OFFSET;
+	writeUInt32(certificate, 0x000, XBE_CERTIFICATE_MIN_SIZE);
+	writeUInt32(certificate, 0x008, titleId);
+	for (uint32_t i = 0; i < 40 && titleName[i] != 0; i++)
+	{
+		certificate[0x00C + (i * 2)] = titleName[i];
+	}
+	writeUInt32(certificate, 0x09C, XBE_MEDIA_TYPE_DVD_X2 | XBE_MEDIA_TYPE_DVD_5_RO);
+	writeUInt32(certificate, 0x0A0, gameRegion);
+	writeUInt32(certificate, 0x0A8, 1);
+	writeUInt32(certificate, 0x0AC, 0x100);
+
+	uint8_t* section = buffer + SAMPLE_SECTION_OFFSET;
+	writeUInt32(section, 0x00, XBE_SECTION_FLAG_PRELOAD);
+	writeUInt32(section, 0x04, 0x12000);
+	writeUInt32(section, 0x08, 0x1000);
+	writeUInt32(section, 0x14, XBE_BASE_ADDRESS + SAMPLE_SECTION_NAME_OFFSET);
+	section += XBE_SECTION_HEADER_SIZE;
+	writeUInt32(section, 0x00, 0);
+	writeUInt32(section, 0x04, 0x13000);
+	writeUInt32(section, 0x08, 0x2000);
+	writeUInt32(section, 0x14, XBE_BASE_ADDRESS + SAMPLE_SECTION_NAME_OFFSET);
+	memcpy(buffer + SAMPLE_SECTION_NAME_OFFSET, ".text", 6);
+
+	return SAMPLE_XBE_SIZE;
+}
+
+bool sampleXbe::create(const char* path, uint32_t titleId, uint32_t gameRegion, const char* titleName)
+{
+	uint8_t buffer[SAMPLE_XBE_SIZE];
+	uint32_t length = build(buffer, titleId, gameRegion, titleName);
+	return hostFileSystem::createFile(path, buffer, length);
+}
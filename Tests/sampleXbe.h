@@ -0,0 +1,15 @@
+#pragma once
+
+#include "xboxinternals.h"
+
+#define SAMPLE_XBE_SIZE 0x1800
+
+// Builds a minimal well formed XBE header block, the section table sits
+// past the first page so readers have to pull in the second one.
+class sampleXbe
+{
+public:
+	static void writeUInt32(uint8_t* buffer, uint32_t offset, uint32_t value);
+	static uint32_t build(uint8_t* buffer, uint32_t titleId, uint32_t gameRegion, const char* titleName);
+	static bool create(const char* path, uint32_t titleId, uint32_t gameRegion, const char* titleName);
+};
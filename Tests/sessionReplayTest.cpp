@@ -0,0 +1,155 @@
+#include "hostTest.h"
+#include "sampleXbe.h"
+#include "discProbe.h"
+#include "sessionRecorder.h"
+#include "fileSystem.h"
+#include "host/hostFileSystem.h"
+
+#define DISC_COUNT 5
+#define TITLE_A 0x4D530004
+#define TITLE_B 0x41560017
+#define TITLE_C 0x54510001
+
+// Records probes of simulated discs laid out under D:, then replays the
+// session with the discs gone, every answer has to come from the records.
+namespace
+{
+	typedef struct probeOutcome
+	{
+		bool launch;
+		uint32_t titleId;
+		char text[128];
+	} probeOutcome;
+
+	mediaType mDiscMedia = mediaTypeUnclassified;
+	probeOutcome mRecorded[DISC_COUNT];
+
+	mediaType simulatedClassifier()
+	{
+		return mDiscMedia;
+	}
+
+	void insertDisc(uint32_t disc)
+	{
+		hostFileSystem::removeTree("D:");
+		hostFileSystem::createFile("D:\\readme.txt", (const uint8_t*)"disc", 4);
+		mDiscMedia = mediaTypeDataDisc;
+		if (disc == 0 || disc == 1)
+		{
+			sampleXbe::create("D:\\default.xbe", TITLE_A, XBE_GAME_REGION_NA, "Title A");
+		}
+		else if (disc == 2)
+		{
+			sampleXbe::create("D:\\Game\\default.xbe", TITLE_B, XBE_GAME_REGION_NA, "Title B");
+		}
+		else if (disc == 3)
+		{
+			// Root is rejected for its region, the folder must not be tried
+			sampleXbe::create("D:\\default.xbe", TITLE_C, XBE_GAME_REGION_JAPAN, "Title C");
+			sampleXbe::create("D:\\Other\\default.xbe", TITLE_B, XBE_GAME_REGION_NA, "Title B");
+		}
+		else
+		{
+			mDiscMedia = mediaTypeDvdVideo;
+		}
+	}
+
+	probeOutcome runProbe()
+	{
+		discProbe::probeResult probe;
+		memset(&probe, 0, sizeof(probe));
+		discProbe::run(&probe);
+
+		probeOutcome outcome;
+		memset(&outcome, 0, sizeof(outcome));
+		outcome.launch = probe.launch;
+		outcome.titleId = probe.titleId;
+		strncpy(outcome.text, probe.launch == true ? probe.launchPath : probe.rejectReason, sizeof(outcome.text) - 1);
+		return outcome;
+	}
+
+	void testRecord()
+	{
+		hostFileSystem::removeTree("E:");
+		hostFileSystem::createFile(SESSION_RECORD_FLAG_PATH, NULL, 0);
+		hostTest::check(sessionRecorder::init() == true && sessionRecorder::isRecording() == true, "recorder did not start recording");
+		discProbe::setClassifier(simulatedClassifier);
+
+		for (uint32_t i = 0; i < DISC_COUNT; i++)
+		{
+			insertDisc(i);
+			mRecorded[i] = runProbe();
+		}
+		hostTest::check(mRecorded[0].launch == true && mRecorded[0].titleId == TITLE_A, "disc 0 did not launch title A");
+		hostTest::check(mRecorded[1].launch == true && strcmp(mRecorded[1].text, mRecorded[0].text) == 0, "disc 1 did not launch from the cache");
+		hostTest::check(mRecorded[2].launch == true && mRecorded[2].titleId == TITLE_B, "disc 2 did not launch its folder XBE");
+		hostTest::check(mRecorded[3].launch == false && strcmp(mRecorded[3].text, xbeHeader::getResultString(xbeHeader::xbeResultBadRegion)) == 0, "disc 3 gave '%s'", mRecorded[3].text);
+		hostTest::check(mRecorded[4].launch == false && strcmp(mRecorded[4].text, mediaClassifier::getMediaTypeMessage(mediaTypeDvdVideo)) == 0, "disc 4 gave '%s'", mRecorded[4].text);
+		hostTest::check(sessionRecorder::save() == true, "session not saved");
+	}
+
+	void testReplay()
+	{
+		hostFileSystem::removeTree("D:");
+		hostTest::check(sessionRecorder::startReplay(SESSION_RECORD_PATH) == true, "recorded session did not load");
+
+		for (uint32_t i = 0; i < DISC_COUNT; i++)
+		{
+			probeOutcome outcome = runProbe();
+			hostTest::check(outcome.launch == mRecorded[i].launch && outcome.titleId == mRecorded[i].titleId && strcmp(outcome.text, mRecorded[i].text) == 0, "disc %u replayed as '%s'", i, outcome.text);
+		}
+
+		sessionRecorder::replayStats stats;
+		sessionRecorder::getReplayStats(stats);
+		hostTest::check(stats.probes == DISC_COUNT && stats.divergences == 0 && stats.exhausted == false, "%u probes replayed, %u diverged", stats.probes, stats.divergences);
+
+		runProbe();
+		sessionRecorder::getReplayStats(stats);
+		hostTest::check(stats.exhausted == true, "probe past the end of the session not reported");
+	}
+
+	// The recorded file answers decide the outcome, rejecting the first
+	// full read of disc 0 must turn its launch into a rejection.
+	void testFileAnswers()
+	{
+		uint32_t fileHandle;
+		uint32_t size = 0;
+		hostTest::check(fileSystem::fileOpen(SESSION_RECORD_PATH, fileSystem::FileModeRead, fileHandle) && fileSystem::fileSize(fileHandle, size), "session not readable");
+		char* buffer = (char*)malloc(size);
+		uint32_t bytesRead = 0;
+		fileSystem::fileRead(fileHandle, buffer, size, bytesRead);
+		fileSystem::fileClose(fileHandle);
+
+		sessionRecorder::sessionRecord* records = (sessionRecorder::sessionRecord*)(buffer + (sizeof(uint32_t) * 3));
+		uint32_t recordCount = (size - (sizeof(uint32_t) * 3)) / sizeof(sessionRecorder::sessionRecord);
+		uint32_t fileAnswers = 0;
+		for (uint32_t i = 0; i < recordCount; i++)
+		{
+			if (records[i].event == sessionEventFileExists && ++fileAnswers == 2)
+			{
+				records[i].value = xbeHeader::xbeResultBadRegion;
+				break;
+			}
+		}
+		uint32_t bytesWritten = 0;
+		fileSystem::fileWrite(SESSION_REPLAY_PATH, buffer, size, bytesWritten);
+		free(buffer);
+
+		hostTest::check(sessionRecorder::startReplay(SESSION_REPLAY_PATH) == true, "edited session did not load");
+		probeOutcome outcome = runProbe();
+		hostTest::check(outcome.launch == false && strcmp(outcome.text, xbeHeader::getResultString(xbeHeader::xbeResultBadRegion)) == 0, "edited answer replayed as '%s'", outcome.text);
+
+		sessionRecorder::replayStats stats;
+		sessionRecorder::getReplayStats(stats);
+		hostTest::check(stats.divergences == 1, "%u divergences from the edited answer", stats.divergences);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hostFileSystem::setRoot(argc > 1 ? argv[1] : ".");
+	testRecord();
+	testReplay();
+	testFileAnswers();
+	return hostTest::result();
+}
@@ -0,0 +1,212 @@
+#include "hostTest.h"
+#include "trayController.h"
+#include "trayMonitor.h"
+
+#define FRAME_MILLISECONDS 16
+#define SMC_OPENING_TIME 300
+#define SMC_OPEN_TIME 1000
+#define SMC_CLOSING_TIME 800
+#define SMC_ACTIVITY_TIME 1500
+#define SMC_DETECT_TIME 2500
+
+// Simulated SMC, eject commands written through the smcWriter seam move
+// the tray through the same states a real drive reports, on a virtual
+// clock so the tests run instantly. The tray is read back through a
+// trayStateReader like trayMonitor reads the real one.
+namespace
+{
+	uint32_t mNow = 0;
+	uint32_t mCommandTime = 0;
+	int32_t mCommand = -1;
+	uint32_t mCommandCount = 0;
+	uint32_t mRestingState = SMC_TRAY_STATE_CLOSED;
+	bool mDiscInserted = true;
+	bool mIgnoreCommands = false;
+	bool mFailWrites = false;
+
+	trayOperation mCompletedOperation = trayOperationNone;
+	trayResult mCompletedResult = trayResultFailed;
+	uint32_t mCompletions = 0;
+	void* mCompletedUserData = NULL;
+
+	void resetSmc(uint32_t restingState, bool discInserted)
+	{
+		mNow = 0;
+		mCommand = -1;
+		mCommandCount = 0;
+		mRestingState = restingState;
+		mDiscInserted = discInserted;
+		mIgnoreCommands = false;
+		mFailWrites = false;
+		mCompletedOperation = trayOperationNone;
+		mCompletedResult = trayResultFailed;
+		mCompletions = 0;
+		mCompletedUserData = NULL;
+	}
+
+	NTSTATUS WINAPI simulatedSmcWriter(UCHAR address, UCHAR command, UCHAR writeWord, DWORD data)
+	{
+		if (mFailWrites == true)
+		{
+			return -1;
+		}
+		if (address == SMBDEV_PIC16L && command == PIC16L_CMD_EJECT)
+		{
+			mCommandCount++;
+			if (mIgnoreCommands == false)
+			{
+				mCommand = (int32_t)data;
+				mCommandTime = mNow;
+			}
+		}
+		return STATUS_SUCCESS;
+	}
+
+	NTSTATUS WINAPI simulatedTrayStateReader(ULONG* trayState, ULONG* ejectCount)
+	{
+		uint32_t elapsed = mNow - mCommandTime;
+		if (mCommand == 0)
+		{
+			*trayState = elapsed < SMC_OPENING_TIME ? SMC_TRAY_STATE_OPENING : (elapsed < SMC_OPEN_TIME ? SMC_TRAY_STATE_UNLOADING : SMC_TRAY_STATE_OPEN);
+		}
+		else if (mCommand == 1 && mDiscInserted == true)
+		{
+			*trayState = elapsed < SMC_CLOSING_TIME ? SMC_TRAY_STATE_CLOSING : (elapsed < SMC_DETECT_TIME ? SMC_TRAY_STATE_ACTIVITY : SMC_TRAY_STATE_MEDIA_DETECT);
+		}
+		else if (mCommand == 1)
+		{
+			*trayState = elapsed < SMC_CLOSING_TIME ? SMC_TRAY_STATE_CLOSING : SMC_TRAY_STATE_NO_MEDIA;
+		}
+		else
+		{
+			*trayState = mRestingState;
+		}
+		return STATUS_SUCCESS;
+	}
+
+	void onCompleted(trayOperation operation, trayResult result, void* userData)
+	{
+		mCompletedOperation = operation;
+		mCompletedResult = result;
+		mCompletedUserData = userData;
+		mCompletions++;
+	}
+
+	// Runs frames until the controller goes idle or the limit passes,
+	// returns the virtual time the operation took.
+	uint32_t runFrames(uint32_t limit)
+	{
+		trayStateReader reader = simulatedTrayStateReader;
+		uint32_t start = mNow;
+		while (trayController::isBusy() == true && mNow - start < limit)
+		{
+			ULONG trayState;
+			reader(&trayState, NULL);
+			trayController::update(trayState, mNow);
+			mNow += FRAME_MILLISECONDS;
+		}
+		return mNow - start;
+	}
+
+	void testEject()
+	{
+		resetSmc(SMC_TRAY_STATE_CLOSED, true);
+		int userData = 0;
+		hostTest::check(trayController::eject(TRAY_EJECT_TIMEOUT, onCompleted, &userData), "eject refused while idle");
+		hostTest::check(mCommandCount == 0, "eject touched the SMBus before update");
+		uint32_t elapsed = runFrames(TRAY_EJECT_TIMEOUT * 2);
+		hostTest::check(mCompletions == 1 && mCompletedOperation == trayOperationEject && mCompletedResult == trayResultCompleted, "eject finished %u times as %s", mCompletions, trayController::getResultString(mCompletedResult));
+		hostTest::check(mCompletedUserData == &userData, "eject lost its user data");
+		hostTest::check(mCommandCount == 1, "eject sent %u commands", mCommandCount);
+		hostTest::check(elapsed >= SMC_OPEN_TIME && elapsed < SMC_OPEN_TIME + (FRAME_MILLISECONDS * 2), "eject completed after %ums", elapsed);
+		printf("Eject completed after %ums\n", elapsed);
+
+		// Already open completes on the first update without a command
+		resetSmc(SMC_TRAY_STATE_OPEN, true);
+		trayController::eject(TRAY_EJECT_TIMEOUT, onCompleted, NULL);
+		runFrames(TRAY_EJECT_TIMEOUT * 2);
+		hostTest::check(mCommandCount == 0 && mCompletedResult == trayResultCompleted, "open tray ejected again");
+	}
+
+	void testClose()
+	{
+		resetSmc(SMC_TRAY_STATE_OPEN, true);
+		trayController::close(TRAY_CLOSE_TIMEOUT, onCompleted, NULL);
+		uint32_t elapsed = runFrames(TRAY_CLOSE_TIMEOUT * 2);
+		hostTest::check(mCompletedOperation == trayOperationClose && mCompletedResult == trayResultCompleted, "close with disc finished as %s", trayController::getResultString(mCompletedResult));
+		hostTest::check(elapsed >= SMC_CLOSING_TIME && elapsed < SMC_CLOSING_TIME + (FRAME_MILLISECONDS * 2), "close completed after %ums", elapsed);
+		printf("Close completed after %ums\n", elapsed);
+
+		resetSmc(SMC_TRAY_STATE_OPEN, false);
+		trayController::close(TRAY_CLOSE_TIMEOUT, onCompleted, NULL);
+		runFrames(TRAY_CLOSE_TIMEOUT * 2);
+		hostTest::check(mCompletedResult == trayResultNoMedia, "close without disc finished as %s", trayController::getResultString(mCompletedResult));
+	}
+
+	void testWaitForMedia()
+	{
+		resetSmc(SMC_TRAY_STATE_OPEN, true);
+		trayController::close(TRAY_CLOSE_TIMEOUT, NULL, NULL);
+		runFrames(TRAY_CLOSE_TIMEOUT * 2);
+		trayController::waitForMedia(TRAY_MEDIA_TIMEOUT, onCompleted, NULL);
+		runFrames(TRAY_MEDIA_TIMEOUT * 2);
+		hostTest::check(mCompletedOperation == trayOperationWaitForMedia && mCompletedResult == trayResultCompleted, "wait for media finished as %s", trayController::getResultString(mCompletedResult));
+		hostTest::check(mNow - mCommandTime >= SMC_DETECT_TIME, "media reported before detect");
+
+		// A drive stuck spinning times out instead of holding the UI
+		resetSmc(SMC_TRAY_STATE_ACTIVITY, true);
+		trayController::waitForMedia(1000, onCompleted, NULL);
+		uint32_t elapsed = runFrames(TRAY_MEDIA_TIMEOUT);
+		hostTest::check(mCompletedResult == trayResultTimedOut && elapsed >= 1000 && elapsed < 1000 + (FRAME_MILLISECONDS * 2), "stuck drive finished as %s after %ums", trayController::getResultString(mCompletedResult), elapsed);
+	}
+
+	void testFailures()
+	{
+		resetSmc(SMC_TRAY_STATE_CLOSED, true);
+		mIgnoreCommands = true;
+		trayController::eject(TRAY_EJECT_TIMEOUT, onCompleted, NULL);
+		uint32_t elapsed = runFrames(TRAY_EJECT_TIMEOUT * 2);
+		hostTest::check(mCompletedResult == trayResultTimedOut && elapsed >= TRAY_EJECT_TIMEOUT, "ignored eject finished as %s after %ums", trayController::getResultString(mCompletedResult), elapsed);
+
+		resetSmc(SMC_TRAY_STATE_CLOSED, true);
+		mFailWrites = true;
+		trayController::eject(TRAY_EJECT_TIMEOUT, onCompleted, NULL);
+		runFrames(TRAY_EJECT_TIMEOUT);
+		hostTest::check(mCompletedResult == trayResultFailed && mCompletions == 1, "failed write finished as %s", trayController::getResultString(mCompletedResult));
+
+		resetSmc(SMC_TRAY_STATE_CLOSED, true);
+		trayController::eject(TRAY_EJECT_TIMEOUT, onCompleted, NULL);
+		hostTest::check(trayController::close(TRAY_CLOSE_TIMEOUT, onCompleted, NULL) == false, "close accepted while ejecting");
+		trayController::cancel();
+		hostTest::check(trayController::isBusy() == false && mCompletedResult == trayResultCancelled, "cancel finished as %s", trayController::getResultString(mCompletedResult));
+		hostTest::check(mCommandCount == 0, "cancelled eject reached the SMBus");
+	}
+
+	void chainClose(trayOperation operation, trayResult result, void* userData)
+	{
+		onCompleted(operation, result, userData);
+		if (operation == trayOperationEject)
+		{
+			hostTest::check(trayController::close(TRAY_CLOSE_TIMEOUT, onCompleted, NULL), "close refused from the eject callback");
+		}
+	}
+
+	void testChaining()
+	{
+		resetSmc(SMC_TRAY_STATE_CLOSED, true);
+		trayController::eject(TRAY_EJECT_TIMEOUT, chainClose, NULL);
+		runFrames(TRAY_EJECT_TIMEOUT + TRAY_CLOSE_TIMEOUT);
+		hostTest::check(mCompletions == 2 && mCompletedOperation == trayOperationClose && mCompletedResult == trayResultCompleted, "eject then close finished %u operations, last %s %s", mCompletions, trayController::getOperationString(mCompletedOperation), trayController::getResultString(mCompletedResult));
+	}
+}
+
+int main()
+{
+	trayController::setSmcWriter(simulatedSmcWriter);
+	testEject();
+	testClose();
+	testWaitForMedia();
+	testFailures();
+	testChaining();
+	return hostTest::result();
+}
@@ -0,0 +1,169 @@
+#include "hostTest.h"
+#include "trayMonitor.h"
+
+#define FRAME_MILLISECONDS 16
+#define MAX_STEPS 64
+
+// Scripted stand-in for HalReadSMCTrayState, each step holds its state
+// from its time (ms after the script starts) until the next step.
+namespace
+{
+	typedef struct scriptStep
+	{
+		uint32_t time;
+		uint32_t trayState;
+	} scriptStep;
+
+	scriptStep mScript[MAX_STEPS];
+	uint32_t mStepCount = 0;
+	uint32_t mScriptStart = 0;
+	volatile LONG mReads = 0;
+
+	uint32_t getScriptTime()
+	{
+		return GetTickCount() - mScriptStart;
+	}
+
+	uint32_t getScriptedState(uint32_t time)
+	{
+		uint32_t trayState = mScript[0].trayState;
+		for (uint32_t i = 0; i < mStepCount && mScript[i].time <= time; i++)
+		{
+			trayState = mScript[i].trayState;
+		}
+		return trayState;
+	}
+
+	NTSTATUS WINAPI scriptedTrayStateReader(ULONG* trayState, ULONG* ejectCount)
+	{
+		InterlockedIncrement(&mReads);
+		*trayState = getScriptedState(getScriptTime());
+		return STATUS_SUCCESS;
+	}
+
+	void beginScript(const scriptStep* steps, uint32_t stepCount)
+	{
+		memcpy(mScript, steps, stepCount * sizeof(scriptStep));
+		mStepCount = stepCount;
+		mReads = 0;
+		mScriptStart = GetTickCount();
+	}
+
+	void drainEvents()
+	{
+		uint32_t trayState;
+		while (trayMonitor::pollEvent(trayState) == true)
+		{
+		}
+	}
+
+	// Consumes events once per frame like trayTask and reports how long
+	// each scripted transition took to reach the main loop.
+	void measureLatency(uint32_t pollScale)
+	{
+		const scriptStep steps[] =
+		{
+			{ 0, SMC_TRAY_STATE_CLOSED },
+			{ 700, SMC_TRAY_STATE_OPENING },
+			{ 900, SMC_TRAY_STATE_OPEN },
+			{ 1900, SMC_TRAY_STATE_CLOSING },
+			{ 2100, SMC_TRAY_STATE_ACTIVITY },
+			{ 2600, SMC_TRAY_STATE_MEDIA_DETECT }
+		};
+		uint32_t stepCount = sizeof(steps) / sizeof(steps[0]);
+
+		trayMonitor::setPollScale(pollScale);
+		beginScript(steps, stepCount);
+		trayMonitor::start();
+
+		// Short lived states can fall between two backed off polls, those
+		// are counted as missed rather than failing the run
+		uint32_t nextStep = 1;
+		uint32_t seen = 0;
+		uint32_t maxLatency = 0;
+		uint32_t totalLatency = 0;
+		bool openSeen = false;
+		while (nextStep < stepCount && getScriptTime() < 4000)
+		{
+			Sleep(FRAME_MILLISECONDS);
+			uint32_t trayState;
+			while (trayMonitor::pollEvent(trayState) == true)
+			{
+				for (uint32_t i = nextStep; i < stepCount; i++)
+				{
+					if (trayState != steps[i].trayState)
+					{
+						continue;
+					}
+					uint32_t latency = getScriptTime() - steps[i].time;
+					maxLatency = max(maxLatency, latency);
+					totalLatency += latency;
+					openSeen = openSeen || trayState == SMC_TRAY_STATE_OPEN;
+					seen++;
+					nextStep = i + 1;
+					break;
+				}
+			}
+		}
+		uint32_t elapsed = getScriptTime();
+		trayMonitor::stop();
+
+		uint32_t transitions = stepCount - 1;
+		printf("Poll scale %u: %u reads over %ums (%.1f/s), %u of %u transitions seen, latency avg %ums max %ums\n", pollScale, (uint32_t)mReads, elapsed, mReads * 1000.0 / elapsed, seen, transitions, seen == 0 ? 0 : totalLatency / seen, maxLatency);
+		hostTest::check(nextStep == stepCount, "scale %u never saw media detect", pollScale);
+		hostTest::check(openSeen == true, "scale %u never saw the tray open", pollScale);
+		hostTest::check(trayMonitor::getTrayState() == SMC_TRAY_STATE_MEDIA_DETECT, "scale %u ended in state 0x%02x", pollScale, trayMonitor::getTrayState());
+
+		// Worst case is a full backed off interval plus the frame it waits for
+		uint32_t latencyBound = 256 * pollScale + FRAME_MILLISECONDS * 2 + 50;
+		hostTest::check(maxLatency <= latencyBound, "scale %u max latency %ums over %ums", pollScale, maxLatency, latencyBound);
+		drainEvents();
+	}
+
+	// Many transitions while the main loop is not consuming must leave the
+	// current state as the newest event instead of dropping it.
+	void testCoalescing()
+	{
+		scriptStep steps[MAX_STEPS];
+		uint32_t stepCount = 0;
+		for (uint32_t i = 0; i < 40; i++)
+		{
+			steps[stepCount].time = i * 40;
+			steps[stepCount].trayState = (i % 2) == 0 ? SMC_TRAY_STATE_OPEN : SMC_TRAY_STATE_CLOSING;
+			stepCount++;
+		}
+		steps[stepCount].time = 40 * 40;
+		steps[stepCount].trayState = SMC_TRAY_STATE_MEDIA_DETECT;
+		stepCount++;
+
+		trayMonitor::setPollScale(1);
+		beginScript(steps, stepCount);
+		trayMonitor::start();
+		Sleep(40 * 40 + 300);
+		trayMonitor::stop();
+
+		uint32_t events = 0;
+		uint32_t lastState = 0xffffffff;
+		uint32_t trayState;
+		while (trayMonitor::pollEvent(trayState) == true)
+		{
+			lastState = trayState;
+			events++;
+		}
+
+		trayMonitor::trayStats stats;
+		trayMonitor::getStats(stats);
+		printf("Coalescing: %u events read, %u coalesced\n", events, stats.coalescedEvents);
+		hostTest::check(lastState == SMC_TRAY_STATE_MEDIA_DETECT, "newest event was 0x%02x instead of media detect", lastState);
+		hostTest::check(stats.coalescedEvents > 0, "a full mailbox coalesced nothing");
+	}
+}
+
+int main()
+{
+	trayMonitor::setTrayStateReader(scriptedTrayStateReader);
+	measureLatency(1);
+	measureLatency(2);
+	testCoalescing();
+	return hostTest::result();
+}
@@ -0,0 +1,81 @@
+#include "hostTest.h"
+#include "sampleXbe.h"
+#include "xbeHeader.h"
+#include "host/hostFileSystem.h"
+
+#define SAMPLE_TITLE_ID 0x4D530004
+
+namespace
+{
+	void testParse()
+	{
+		uint8_t buffer[SAMPLE_XBE_SIZE];
+		uint32_t length = sampleXbe::build(buffer, SAMPLE_TITLE_ID, XBE_GAME_REGION_NA, "Sample");
+
+		xbeHeader::xbeInfo info;
+		xbeHeader::xbeResult result = xbeHeader::parse(buffer, length, info);
+		hostTest::check(result == xbeHeader::xbeResultOk, "sample header parsed as %s", xbeHeader::getResultString(result));
+		hostTest::check(info.titleId == SAMPLE_TITLE_ID, "title id %08x", info.titleId);
+		hostTest::check(strcmp(info.titleName, "Sample") == 0, "title name '%s'", info.titleName);
+		hostTest::check(info.sectionCount == 2 && info.preloadSize == 0x1000 && info.deferredSize == 0x2000, "sections %u, preload %x, deferred %x", info.sectionCount, info.preloadSize, info.deferredSize);
+		hostTest::check(xbeHeader::validate(info, XBE_GAME_REGION_NA) == xbeHeader::xbeResultOk, "NA title rejected on an NA console");
+		hostTest::check(xbeHeader::validate(info, XBE_GAME_REGION_JAPAN) == xbeHeader::xbeResultBadRegion, "NA title accepted on a Japanese console");
+
+		// Headers cut short of sizeOfHeaders must not be walked
+		hostTest::check(xbeHeader::parse(buffer, 0x1000, info) == xbeHeader::xbeResultBadHeaderSize, "truncated header accepted");
+		hostTest::check(xbeHeader::parse(buffer, 0x100, info) == xbeHeader::xbeResultBadHeaderSize, "short buffer accepted");
+
+		sampleXbe::writeUInt32(buffer, 0x000, 0);
+		hostTest::check(xbeHeader::parse(buffer, length, info) == xbeHeader::xbeResultBadMagic, "bad magic accepted");
+		sampleXbe::writeUInt32(buffer, 0x000, XBE_MAGIC);
+
+		sampleXbe::writeUInt32(buffer, 0x104, 0x20000);
+		hostTest::check(xbeHeader::parse(buffer, length, info) == xbeHeader::xbeResultBadBaseAddress, "bad base address accepted");
+		sampleXbe::writeUInt32(buffer, 0x104, XBE_BASE_ADDRESS);
+
+		sampleXbe::writeUInt32(buffer, 0x11C, 1000);
+		hostTest::check(xbeHeader::parse(buffer, length, info) == xbeHeader::xbeResultBadSectionTable, "oversized section table accepted");
+		sampleXbe::writeUInt32(buffer, 0x11C, 2);
+
+		sampleXbe::writeUInt32(buffer, 0x118, XBE_BASE_ADDRESS + SAMPLE_XBE_SIZE - 0x10);
+		hostTest::check(xbeHeader::parse(buffer, length, info) == xbeHeader::xbeResultBadCertificate, "certificate past the headers accepted");
+	}
+
+	void testValidate()
+	{
+		uint8_t buffer[SAMPLE_XBE_SIZE];
+		uint32_t length = sampleXbe::build(buffer, SAMPLE_TITLE_ID, XBE_GAME_REGION_MANUFACTURING, "Debug");
+
+		xbeHeader::xbeInfo info;
+		hostTest::check(xbeHeader::parse(buffer, length, info) == xbeHeader::xbeResultOk, "manufacturing header rejected");
+		hostTest::check(xbeHeader::validate(info, XBE_GAME_REGION_RESTOFWORLD) == xbeHeader::xbeResultOk, "manufacturing region not accepted everywhere");
+
+		info.allowedMediaTypes = XBE_MEDIA_TYPE_HARD_DISK;
+		hostTest::check(xbeHeader::validate(info, XBE_GAME_REGION_RESTOFWORLD) == xbeHeader::xbeResultBadMediaType, "hard disk only title accepted from disc");
+	}
+
+	void testRead()
+	{
+		hostTest::check(sampleXbe::create("D:\\default.xbe", SAMPLE_TITLE_ID, XBE_GAME_REGION_NA, "Sample"), "unable to create sample default.xbe");
+
+		xbeHeader::xbeInfo info;
+		xbeHeader::xbeResult result = xbeHeader::read("D:\\default.xbe", info);
+		hostTest::check(result == xbeHeader::xbeResultOk, "read returned %s", xbeHeader::getResultString(result));
+		hostTest::check(info.sectionCount == 2, "read missed the second page, %u sections", info.sectionCount);
+
+		result = xbeHeader::readIdentity("D:\\default.xbe", info);
+		hostTest::check(result == xbeHeader::xbeResultOk && info.titleId == SAMPLE_TITLE_ID, "identity returned %s, title id %08x", xbeHeader::getResultString(result), info.titleId);
+		hostTest::check(info.sectionCount == 0, "identity walked the section table");
+
+		hostTest::check(xbeHeader::read("D:\\missing.xbe", info) == xbeHeader::xbeResultReadFailed, "missing file read");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hostFileSystem::setRoot(argc > 1 ? argv[1] : ".");
+	testParse();
+	testValidate();
+	testRead();
+	return hostTest::result();
+}